@@ -1,10 +1,30 @@
 #include "Clock.h"
+#include <avr/sleep.h>
 
 Clock::Clock(int stepsPerRev, int motorPin1, int motorPin2, int motorPin3, int motorPin4,
              int sensorPin, int neopixelPin, int hourLeds, int minuteLeds,
              uint8_t brightness, int motorSpeed)
+    : Clock(*new ClockDisplay(neopixelPin, hourLeds, minuteLeds, brightness), true,
+            stepsPerRev, motorPin1, motorPin2, motorPin3, motorPin4, sensorPin, motorSpeed) {
+}
+
+Clock::Clock(const RingGeometry& geometry, int stepsPerRev, int motorPin1, int motorPin2,
+             int motorPin3, int motorPin4, int sensorPin, int neopixelPin,
+             uint8_t brightness, int motorSpeed)
+    : Clock(*new ClockDisplay(neopixelPin, geometry, brightness), true,
+            stepsPerRev, motorPin1, motorPin2, motorPin3, motorPin4, sensorPin, motorSpeed) {
+}
+
+Clock::Clock(ClockDisplay& display, int stepsPerRev, int motorPin1, int motorPin2,
+             int motorPin3, int motorPin4, int sensorPin, int motorSpeed)
+    : Clock(display, false, stepsPerRev, motorPin1, motorPin2, motorPin3, motorPin4, sensorPin, motorSpeed) {
+}
+
+Clock::Clock(ClockDisplay& display, bool ownsDisplay, int stepsPerRev, int motorPin1, int motorPin2,
+             int motorPin3, int motorPin4, int sensorPin, int motorSpeed)
     : clockMotor(stepsPerRev, motorPin1, motorPin2, motorPin3, motorPin4, sensorPin, motorSpeed)
-    , clockDisplay(neopixelPin, hourLeds, minuteLeds, brightness)
+    , clockDisplay(display)
+    , ownsDisplay(ownsDisplay)
     , externalRTC(nullptr)
     , usingExternalRTC(false)
     , centeringAdjustment(CENTERING_ADJUSTMENT)
@@ -13,15 +33,42 @@ Clock::Clock(int stepsPerRev, int motorPin1, int motorPin2, int motorPin3, int m
     , quietHoursStart(QUIET_HOURS_START)
     , quietHoursEnd(QUIET_HOURS_END)
     , quietBrightnessPercent(QUIET_BRIGHTNESS_PERCENT)
-    , defaultBrightness(brightness)
+    , quietRampMinutes(QUIET_RAMP_MINUTES)
+    , defaultBrightness(display.getBrightness())
+    , activeBrightness(display.getBrightness())
+    , quietLevel(0)
+    , autoBrightnessEnabled(false)
+    , lightSensorPin(AMBIENT_LIGHT_PIN)
+    , autoMinBrightness(AMBIENT_MIN_BRIGHTNESS)
     , hourChangeAnimationEnabled(true)
+    , quarterHourEffectsEnabled(false)
+    , secondsSweepEnabled(false)
     , microCalibrationEnabled(false)
     , microCalibrationInterval(4)
     , hourlyPatternRotation(false)
     , displayPattern(ClockDisplay::DEFAULT_COMPLEMENT)
+    , patternTransitionTime(PATTERN_TRANSITION_TIME)
     , calibrated(false)
     , lastHourForAnimation(-1)
-    , lastHourForPattern(-1) {
+    , lastHourForPattern(-1)
+    , microCalibrationPending(false)
+    , targetFps(TARGET_FPS)
+    , frameFps(TARGET_FPS)
+    , frameInterval(1000 / TARGET_FPS)
+    , nextFrameTime(0)
+    , nextRtcPollTime(0)
+    , fpsWindowStart(0)
+    , framesThisSecond(0)
+    , achievedFps(0)
+    , droppedFrames(0)
+    , idleMicros(0)
+    , idlePercent(0) {
+}
+
+Clock::~Clock() {
+    if (ownsDisplay) {
+        delete &clockDisplay;
+    }
 }
 
 void Clock::begin(DS3231* rtcPtr) {
@@ -41,6 +88,9 @@ void Clock::begin(DS3231* rtcPtr) {
     clockTime.begin();
     clockMotor.begin();
     clockDisplay.begin();
+    if (autoBrightnessEnabled) {
+        lightSensor.begin(lightSensorPin);
+    }
     
     // Perform calibration
     performCalibration();
@@ -55,14 +105,20 @@ void Clock::begin(DS3231* rtcPtr) {
     Serial.print(":");
     Serial.println(initialMinute);
     
-    // Set initial brightness based on quiet hours
-    if (quietHoursEnabled) {
-        updateQuietHoursBrightness();
+    // Set initial brightness based on quiet hours and room light
+    if (quietHoursEnabled || autoBrightnessEnabled) {
+        updateBrightness();
+        updateQuietRamp();
     }
     
     // Move to current minute position
     clockMotor.moveToMinute(initialMinute);
     
+    // Start the frame and RTC schedules from now
+    nextFrameTime = millis();
+    nextRtcPollTime = nextFrameTime;
+    fpsWindowStart = nextFrameTime;
+    
     Serial.println("=== Clock System Ready ===");
 }
 
@@ -71,7 +127,7 @@ void Clock::performCalibration() {
     
     // Show calibration indicator
     clockDisplay.clear();
-    clockDisplay.fill(clockDisplay.getPixels().Color(10, 10, 10));
+    clockDisplay.fill(Adafruit_NeoPixel::Color(10, 10, 10));
     clockDisplay.show();
     
     // Calibrate motor
@@ -80,25 +136,41 @@ void Clock::performCalibration() {
     if (calibrated) {
         // Show success
         clockDisplay.clear();
-        clockDisplay.getPixels().setPixelColor(0, clockDisplay.getPixels().Color(0, 255, 0));
+        clockDisplay.setPixelColor(0, Adafruit_NeoPixel::Color(0, 255, 0));
         clockDisplay.show();
         delay(2000);
         Serial.println("Clock: Calibration successful");
     } else {
         // Show error
         clockDisplay.clear();
-        clockDisplay.getPixels().setPixelColor(0, clockDisplay.getPixels().Color(255, 0, 0));
+        clockDisplay.setPixelColor(0, Adafruit_NeoPixel::Color(255, 0, 0));
         clockDisplay.show();
         delay(2000);
         Serial.println("Clock: Calibration failed");
     }
 }
 
-void Clock::enableQuietHours(bool enable, int start, int end, int percent) {
+void Clock::performMicroCalibration() {
+    microCalibrationPending = false;
+    
+    Serial.println("Clock: Performing micro-calibration");
+    clockMotor.powerOn();
+    clockMotor.microCalibrate(centeringAdjustment, slowDelay);
+    
+    // After micro-calibration, hand is at position 0 (12 o'clock)
+    // Move it back to current minute position (which should be 59 or 0)
+    int currentMinute = clockTime.getMinute();
+    clockMotor.moveToMinute(currentMinute);
+    
+    clockMotor.powerOff();
+}
+
+void Clock::enableQuietHours(bool enable, int start, int end, int percent, int rampMinutes) {
     quietHoursEnabled = enable;
     quietHoursStart = start;
     quietHoursEnd = end;
     quietBrightnessPercent = percent;
+    quietRampMinutes = rampMinutes;
     
     if (enable) {
         Serial.print("Clock: Quiet hours enabled (");
@@ -107,20 +179,111 @@ void Clock::enableQuietHours(bool enable, int start, int end, int percent) {
         Serial.print(end);
         Serial.print(":00, ");
         Serial.print(percent);
-        Serial.println("% brightness)");
+        Serial.print("% brightness, ");
+        Serial.print(rampMinutes);
+        Serial.println(" min ramps)");
     } else {
         Serial.println("Clock: Quiet hours disabled");
     }
 }
 
+void Clock::enableAutoBrightness(bool enable, uint8_t pin, uint8_t minBrightness) {
+    autoBrightnessEnabled = enable;
+    lightSensorPin = pin;
+    autoMinBrightness = min(minBrightness, defaultBrightness);
+    if (!enable) {
+        lightSensor.end();
+    }
+}
+
+void Clock::setTargetFps(uint8_t fps) {
+    if (fps == 0) {
+        fps = 1;
+    }
+    targetFps = fps;
+    frameFps = fps;
+    frameInterval = 1000 / fps;
+}
+
+void Clock::updateFrameRate() {
+    uint8_t fps = clockDisplay.getRequiredFps(targetFps);
+    if (secondsSweepEnabled) {
+        fps = max(fps, min((uint8_t)SECONDS_SWEEP_FPS, targetFps));
+    }
+    // Dithering needs the full rate, quiet or not
+    if (clockDisplay.isQuietMode() && !clockDisplay.isDithering()) {
+        fps = max(1, fps * QUIET_FPS_PERCENT / 100);
+    }
+    frameFps = fps;
+    frameInterval = 1000 / fps;
+    
+    // Patterns may use this share of the frame before they drop quality
+    clockDisplay.setRenderBudget(min((uint32_t)frameInterval * 10 * RENDER_BUDGET_PERCENT, 0xFFFFUL));
+}
+
+void Clock::handleSerialCommand(char command) {
+    switch (command) {
+        case 'c':
+            clockDisplay.printPatternCosts();
+            break;
+    }
+}
+
+void Clock::sleepUntilInterrupt() {
+    // Idle sleep keeps the timers, ADC and serial running, and the next
+    // interrupt - at most the millis() tick, about 1 ms away - wakes us
+    uint32_t start = micros();
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_mode();
+    idleMicros += micros() - start;
+}
+
 void Clock::update() {
-    // Update time from RTC
-    if (!clockTime.update()) {
-        // Second hasn't changed, nothing to do
-        delay(RTC_CHECK_DELAY);
-        return;
+    uint32_t now = millis();
+    
+    // Poll the RTC on its own cadence
+    if ((int32_t)(now - nextRtcPollTime) >= 0) {
+        nextRtcPollTime = now + RTC_CHECK_DELAY;
+        if (clockTime.update()) {
+            handleSecondChange();
+        }
+        
+        // Pin down the second rollover for the seconds sweep: poll every
+        // RTC_FAST_POLL_DELAY from just before it is due until it is seen
+        if (secondsSweepEnabled) {
+            uint16_t until = clockTime.getMillisUntilSecond();
+            if (until < RTC_CHECK_DELAY + RTC_FAST_POLL_DELAY) {
+                uint16_t wait = until > 2 * RTC_FAST_POLL_DELAY ? until - RTC_FAST_POLL_DELAY : RTC_FAST_POLL_DELAY;
+                nextRtcPollTime = millis() + wait;
+            }
+        }
+    }
+    
+    // Room light level - a new level only every few seconds at most
+    if (autoBrightnessEnabled && lightSensor.update()) {
+        updateBrightness();
+    }
+    
+    if (Serial.available() > 0) {
+        handleSerialCommand(Serial.read());
+    }
+    
+    // Micro-calibration waits for the hour change animation to complete
+    if (microCalibrationPending && !clockDisplay.isEffectRunning()) {
+        performMicroCalibration();
     }
     
+    // Render on the frame schedule (re-read the time, second handling may block)
+    now = millis();
+    if ((int32_t)(now - nextFrameTime) >= 0) {
+        renderFrame(now);
+    } else if ((int32_t)(now - nextRtcPollTime) < 0 && !microCalibrationPending) {
+        // Nothing due - sleep rather than spin
+        sleepUntilInterrupt();
+    }
+}
+
+void Clock::handleSecondChange() {
     // Handle minute change
     if (clockTime.hasMinuteChanged()) {
         handleMinuteChange();
@@ -145,26 +308,11 @@ void Clock::update() {
             Serial.print(nextHour);
             Serial.println(")");
             
-            clockDisplay.showWindmillHourChange(nextHour);
+            clockDisplay.startEffect(ClockDisplay::EFFECT_WINDMILL);
             
-            // Perform micro-calibration if enabled
+            // Micro-calibrate once the animation has finished
             if (microCalibrationEnabled && nextHour % microCalibrationInterval == 0) {
-                Serial.println("Clock: Performing micro-calibration");
-                clockMotor.powerOn();
-                clockMotor.microCalibrate(centeringAdjustment, slowDelay);
-                
-                // After micro-calibration, hand is at position 0 (12 o'clock)
-                // Move it back to current minute position (which should be 59 or 0)
-                int currentMinute = clockTime.getMinute();
-                clockMotor.moveToMinute(currentMinute);
-                
-                clockMotor.powerOff();
-            }
-            
-            // Update brightness for next hour
-            if (quietHoursEnabled) {
-                clockDisplay.setQuietMode(isQuietHours(nextHour, quietHoursStart, quietHoursEnd));
-                updateQuietHoursBrightness();
+                microCalibrationPending = true;
             }
             
             lastHourForAnimation = nextHour;
@@ -176,24 +324,107 @@ void Clock::update() {
         if (hour != lastHourForPattern) {
             if (lastHourForPattern != -1) {
                 // Select random pattern (0-3 for first four patterns)
-                randomSeed(analogRead(A7) + hour);
-                displayPattern = (ClockDisplay::Pattern)random(4);
+                // (the light sensor owns the ADC when running)
+                uint16_t noise = lightSensor.isRunning() ? lightSensor.getLastSample() : analogRead(A7);
+                randomSeed(noise + hour);
+                ClockDisplay::Pattern nextPattern = (ClockDisplay::Pattern)random(4);
+                if (nextPattern != displayPattern) {
+                    clockDisplay.startTransition(displayPattern, patternTransitionTime);
+                    displayPattern = nextPattern;
+                }
                 Serial.print("Clock: Pattern changed to ");
                 Serial.println(displayPattern);
             }
             lastHourForPattern = hour;
         }
     }
+}
+
+void Clock::renderFrame(uint32_t now) {
+    updateFrameRate();
+    
+    uint32_t late = now - nextFrameTime;
+    if (late >= frameInterval) {
+        // Missed one or more whole frames - count them and resync
+        droppedFrames += late / frameInterval;
+        nextFrameTime = now + frameInterval;
+    } else {
+        nextFrameTime += frameInterval;
+    }
+    
+    if (quietHoursEnabled || autoBrightnessEnabled) {
+        updateQuietRamp();
+    }
     
-    // Update display
     updateDisplay();
+    
+    // Achieved frame rate and time asleep over the last second or so
+    // (at low frame rates the window overruns by up to a frame)
+    framesThisSecond++;
+    uint32_t window = now - fpsWindowStart;
+    if (window >= 1000) {
+        achievedFps = (framesThisSecond * 1000UL + window / 2) / window;
+        idlePercent = min(100UL, idleMicros / (window * 10));
+        framesThisSecond = 0;
+        idleMicros = 0;
+        fpsWindowStart = now;
+    }
 }
 
 void Clock::handleMinuteChange() {
     int minute = clockTime.getMinute();
     
     Serial.print("Clock: Minute changed to ");
-    Serial.println(minute);
+    Serial.print(minute);
+    Serial.print(" (");
+    Serial.print(achievedFps);
+    Serial.print(" of ");
+    Serial.print(frameFps);
+    Serial.print(" fps for pattern ");
+    Serial.print(clockDisplay.getCurrentPattern());
+    Serial.print(", ");
+    Serial.print(idlePercent);
+    Serial.print("% idle, ");
+    Serial.print(droppedFrames);
+    Serial.println(" dropped)");
+    
+    if (clockDisplay.getParticleMode() != ClockDisplay::PARTICLES_NONE) {
+        const ParticleSystem& particles = clockDisplay.getParticles();
+        Serial.print("Clock: Particles ");
+        Serial.print(particles.getActiveCount());
+        Serial.print("/");
+        Serial.print(particles.getPoolSize());
+        Serial.print(" (peak ");
+        Serial.print(particles.getPeakCount());
+        Serial.print(", ");
+        Serial.print(particles.getDroppedSpawns());
+        Serial.println(" spawns dropped)");
+    }
+    
+    Serial.print("Clock: LEDs ");
+    Serial.print(clockDisplay.getOutputMilliamps());
+    Serial.print(" mA (peak ");
+    Serial.print(clockDisplay.getPeakMilliamps());
+    if (clockDisplay.getPowerBudget() != 0) {
+        Serial.print(" mA, ");
+        Serial.print(clockDisplay.getPowerBudgetPercent());
+        Serial.print("% of ");
+        Serial.print(clockDisplay.getPowerBudget());
+        Serial.print(" mA budget, ");
+        Serial.print(clockDisplay.getLimitedFrames());
+        Serial.println(" frames limited)");
+    } else {
+        Serial.println(" mA)");
+    }
+    
+    // Quarter-hour blooms, unless the hour change animation is running
+    if (quarterHourEffectsEnabled && minute % 15 == 0 && minute != 0 && !clockDisplay.isEffectRunning()) {
+        Serial.print("Clock: Quarter-hour effect at :");
+        Serial.println(minute);
+        const TimelineSequence* sequence =
+            (const TimelineSequence*)pgm_read_ptr(&QUARTER_HOUR_TIMELINES[minute / 15 - 1]);
+        clockDisplay.startTimeline(sequence);
+    }
     
     // Move hand to new position
     clockMotor.moveToMinute(minute);
@@ -204,44 +435,89 @@ void Clock::handleHourChange() {
     
     Serial.print("Clock: Hour changed to ");
     Serial.println(hour);
-    
-    // Update brightness if quiet hours changed
-    if (quietHoursEnabled) {
-        updateQuietHoursBrightness();
-    }
 }
 
 void Clock::updateDisplay() {
-    clockDisplay.clear();
+    // A full-frame effect covers the pattern, so the pattern can pause
+    bool effectDrawn = clockDisplay.renderEffect();
+    if (effectDrawn && clockDisplay.isEffectFullFrame()) {
+        clockDisplay.show();
+        return;
+    }
     
     // Display current pattern
     clockDisplay.displayPattern(displayPattern);
     
-    // Overlay hour indicators
+    if (secondsSweepEnabled && clockTime.hasSecondPhase()) {
+        clockDisplay.showSecondsIndicator(clockTime.getSecondsAngle());
+    }
+    
+    // Overlay hour indicators (redrawn only when the hour changes)
     clockDisplay.showHourIndicators(clockTime.getHour12());
     
+    // Particles are added over both
+    clockDisplay.renderParticles();
+    
     clockDisplay.show();
 }
 
-void Clock::updateQuietHoursBrightness() {
-    int currentHour = clockTime.getHour();
-    bool isQuiet = isQuietHours(currentHour, quietHoursStart, quietHoursEnd);
+void Clock::updateBrightness() {
+    // Room light sets the full brightness; quiet hours scale it down
+    // frame by frame in updateQuietRamp()
+    uint8_t brightness = defaultBrightness;
+    if (autoBrightnessEnabled) {
+        brightness = autoMinBrightness +
+            (uint32_t)(defaultBrightness - autoMinBrightness) * lightSensor.getLevel() / 1023;
+    }
+    
+    if (brightness != activeBrightness) {
+        activeBrightness = brightness;
+        logBrightness();
+    }
+}
+
+void Clock::updateQuietRamp() {
+    uint16_t level = 0;
+    if (quietHoursEnabled) {
+        level = getQuietLevel(clockTime.getHour(), clockTime.getMinute(), clockTime.getSecond(),
+                              quietHoursStart, quietHoursEnd, quietRampMinutes);
+    }
     
-    clockDisplay.setQuietMode(isQuiet);
+    // 8.8 fixed-point blend from the active to the quiet brightness
+    uint8_t quietBrightness = getQuietBrightness(activeBrightness, quietBrightnessPercent);
+    uint8_t brightness = activeBrightness -
+        (((uint16_t)(activeBrightness - quietBrightness) * level + 128) >> 8);
+    clockDisplay.setBrightness(brightness);
+    clockDisplay.setQuietLevel(level);
     
-    uint8_t targetBrightness;
-    if (isQuiet) {
-        targetBrightness = getQuietBrightness(defaultBrightness, quietBrightnessPercent);
-    } else {
-        targetBrightness = defaultBrightness;
+    // Log when a ramp starts and when it finishes
+    uint8_t phase = level == 0 ? 0 : (level == 256 ? 2 : 1);
+    uint8_t lastPhase = quietLevel == 0 ? 0 : (quietLevel == 256 ? 2 : 1);
+    quietLevel = level;
+    if (phase != lastPhase) {
+        logBrightness();
     }
+}
+
+void Clock::logBrightness() {
+    uint8_t quietBrightness = getQuietBrightness(activeBrightness, quietBrightnessPercent);
     
-    if (clockDisplay.getBrightness() != targetBrightness) {
-        clockDisplay.setBrightness(targetBrightness);
-        Serial.print("Clock: Brightness changed to ");
-        Serial.print(targetBrightness);
-        Serial.print(" (");
-        Serial.print(isQuiet ? "QUIET" : "ACTIVE");
-        Serial.println(" mode)");
+    Serial.print("Clock: Brightness changed to ");
+    if (quietLevel == 0) {
+        Serial.print(activeBrightness);
+        Serial.print(" (ACTIVE mode");
+    } else if (quietLevel == 256) {
+        Serial.print(quietBrightness);
+        Serial.print(" (QUIET mode");
+    } else {
+        Serial.print(activeBrightness);
+        Serial.print("-");
+        Serial.print(quietBrightness);
+        Serial.print(" (RAMP mode");
+    }
+    if (autoBrightnessEnabled) {
+        Serial.print(", light ");
+        Serial.print(lightSensor.getLevel());
     }
+    Serial.println(")");
 }
@@ -6,6 +6,7 @@
 #include <ClockTime.h>
 #include <ClockMotor.h>
 #include <ClockDisplay.h>
+#include <ClockLightSensor.h>
 #include <ClockConfig.h>
 
 /**
@@ -14,6 +15,9 @@
  * Orchestrates ClockTime, ClockMotor, and ClockDisplay to create
  * a complete clock system with a simple API.
  * 
+ * Serial commands (one character, at 115200):
+ *   c - print the measured render cost of each pattern
+ * 
  * Usage:
  *   Clock clock;
  *   
@@ -27,6 +31,7 @@
  */
 class Clock {
 public:
+    // Owns a runtime-sized ClockDisplay of hourLeds + minuteLeds
     Clock(int stepsPerRev = STEPS_PER_REVOLUTION,
           int motorPin1 = FIRST_MOTOR_PIN,
           int motorPin2 = FIRST_MOTOR_PIN + 1,
@@ -39,6 +44,33 @@ public:
           uint8_t brightness = DEFAULT_BRIGHTNESS,
           int motorSpeed = MOTOR_SPEED);
     
+    // Owns a ClockDisplay laid out by geometry (any number of rings, or
+    // a per-LED table)
+    Clock(const RingGeometry& geometry,
+          int stepsPerRev = STEPS_PER_REVOLUTION,
+          int motorPin1 = FIRST_MOTOR_PIN,
+          int motorPin2 = FIRST_MOTOR_PIN + 1,
+          int motorPin3 = FIRST_MOTOR_PIN + 2,
+          int motorPin4 = FIRST_MOTOR_PIN + 3,
+          int sensorPin = SENSOR_PIN,
+          int neopixelPin = NEOPIXEL_PIN,
+          uint8_t brightness = DEFAULT_BRIGHTNESS,
+          int motorSpeed = MOTOR_SPEED);
+    
+    // Drives a display the application owns, such as a StaticClockDisplay
+    // sized where the LED counts are defined. Clock keeps a reference,
+    // so its own layout doesn't depend on the display's sizes; the
+    // display must outlive it.
+    Clock(ClockDisplay& display,
+          int stepsPerRev = STEPS_PER_REVOLUTION,
+          int motorPin1 = FIRST_MOTOR_PIN,
+          int motorPin2 = FIRST_MOTOR_PIN + 1,
+          int motorPin3 = FIRST_MOTOR_PIN + 2,
+          int motorPin4 = FIRST_MOTOR_PIN + 3,
+          int sensorPin = SENSOR_PIN,
+          int motorSpeed = MOTOR_SPEED);
+    ~Clock();
+    
     // Initialize clock system with external RTC
     // If rtcPtr is nullptr, will use internal RTC instance
     void begin(DS3231* rtcPtr = nullptr);
@@ -50,26 +82,55 @@ public:
     ClockTime& getTime() { return clockTime; }
     ClockMotor& getMotor() { return clockMotor; }
     ClockDisplay& getDisplay() { return clockDisplay; }
+    ClockLightSensor& getLightSensor() { return lightSensor; }
     
     // Configuration
     void setCenteringAdjustment(int adjustment) { centeringAdjustment = adjustment; }
     void setSlowDelay(int delay) { slowDelay = delay; }
-    void enableQuietHours(bool enable, int start = QUIET_HOURS_START, int end = QUIET_HOURS_END, int percent = QUIET_BRIGHTNESS_PERCENT);
+    // Quiet hours fade in from start and out from end over rampMinutes,
+    // dimming to percent and warming the colors
+    void enableQuietHours(bool enable, int start = QUIET_HOURS_START, int end = QUIET_HOURS_END,
+                          int percent = QUIET_BRIGHTNESS_PERCENT, int rampMinutes = QUIET_RAMP_MINUTES);
+    // Scale brightness with the room light, from minBrightness in the dark
+    // up to the default brightness; quiet hours still reduce it by their
+    // percentage. Call before begin(), which starts the sensor and
+    // hands it the ADC.
+    void enableAutoBrightness(bool enable, uint8_t pin = AMBIENT_LIGHT_PIN,
+                              uint8_t minBrightness = AMBIENT_MIN_BRIGHTNESS);
     void enableHourChangeAnimation(bool enable) { hourChangeAnimationEnabled = enable; }
+    void enableQuarterHourEffects(bool enable) { quarterHourEffectsEnabled = enable; }
+    // Seconds dot sweeping smoothly around the minute ring, from the
+    // RTC's sub-second phase. Polls the RTC every RTC_FAST_POLL_DELAY
+    // around each second rollover and renders at SECONDS_SWEEP_FPS or more.
+    void enableSecondsSweep(bool enable) { secondsSweepEnabled = enable; }
     void enableMicroCalibration(bool enable, int everyNHours = 4) { 
         microCalibrationEnabled = enable;
         microCalibrationInterval = everyNHours;
     }
     void setDisplayPattern(ClockDisplay::Pattern pattern) { displayPattern = pattern; }
     void enableHourlyPatternRotation(bool enable) { hourlyPatternRotation = enable; }
+    void setPatternTransitionTime(uint16_t ms) { patternTransitionTime = ms; }
+    
+    // Frame scheduling - LEDs render independent of the RTC tick, at the
+    // rate the pattern needs (ClockDisplay::getRequiredFps) up to
+    // targetFps, reduced to QUIET_FPS_PERCENT in quiet hours unless a
+    // ring is dithering. Time between frames is spent in idle sleep.
+    void setTargetFps(uint8_t fps);
+    uint8_t getTargetFps() const { return targetFps; }
+    uint8_t getFrameFps() const { return frameFps; }
     
     // Status
     bool isCalibrated() const { return calibrated; }
+    uint8_t getAchievedFps() const { return achievedFps; }
+    uint8_t getIdlePercent() const { return idlePercent; }   // CPU time asleep over the last second
+    uint32_t getDroppedFrames() const { return droppedFrames; }
     
 private:
     ClockTime clockTime;
     ClockMotor clockMotor;
-    ClockDisplay clockDisplay;
+    ClockDisplay& clockDisplay;
+    bool ownsDisplay;
+    ClockLightSensor lightSensor;
     
     DS3231* externalRTC;
     bool usingExternalRTC;
@@ -81,24 +142,58 @@ private:
     int quietHoursStart;
     int quietHoursEnd;
     int quietBrightnessPercent;
+    int quietRampMinutes;
     uint8_t defaultBrightness;
+    uint8_t activeBrightness;   // Brightness outside quiet hours (default or from room light)
+    uint16_t quietLevel;        // 0 normal to 256 fully quiet, from the RTC time
+    bool autoBrightnessEnabled;
+    uint8_t lightSensorPin;
+    uint8_t autoMinBrightness;
     bool hourChangeAnimationEnabled;
+    bool quarterHourEffectsEnabled;
+    bool secondsSweepEnabled;
     bool microCalibrationEnabled;
     int microCalibrationInterval;
     bool hourlyPatternRotation;
     ClockDisplay::Pattern displayPattern;
+    uint16_t patternTransitionTime;
     
     // State
     bool calibrated;
     int lastHourForAnimation;
     int lastHourForPattern;
+    bool microCalibrationPending;
+    
+    // Frame scheduler
+    uint8_t targetFps;
+    uint8_t frameFps;
+    uint16_t frameInterval;
+    uint32_t nextFrameTime;
+    uint32_t nextRtcPollTime;
+    uint32_t fpsWindowStart;
+    uint8_t framesThisSecond;
+    uint8_t achievedFps;
+    uint32_t droppedFrames;
+    uint32_t idleMicros;
+    uint8_t idlePercent;
+    
+    Clock(ClockDisplay& display, bool ownsDisplay, int stepsPerRev, int motorPin1, int motorPin2,
+          int motorPin3, int motorPin4, int sensorPin, int motorSpeed);
     
     // Helper methods
     void performCalibration();
+    void performMicroCalibration();
+    void handleSecondChange();
+    void renderFrame(uint32_t now);
+    void updateFrameRate();
+    void handleSerialCommand(char command);
+    void sleepUntilInterrupt();
     void handleMinuteChange();
     void handleHourChange();
     void updateDisplay();
-    void updateQuietHoursBrightness();
+    void updateBrightness();
+    void updateQuietRamp();
+    void logBrightness();
 };
 
 #endif // CLOCK_H
@@ -51,11 +51,94 @@
 #define DEFAULT_BRIGHTNESS 63
 #endif
 
+#ifndef CLOCK_MAX_RINGS
+#define CLOCK_MAX_RINGS 4
+#endif
+
+// SPI clock for APA102/SK9822 strips (ClockDisplay built with
+// CLOCK_OUTPUT_APA102); an ATmega328 at 16 MHz tops out at 8 MHz
+#ifndef APA102_SPI_HZ
+#define APA102_SPI_HZ 8000000
+#endif
+
+// EEPROM address of the color correction table (saved by
+// ClockDisplay::saveColorCorrection). It takes 6 bytes plus 3 per ring,
+// and with per-LED gains 3 more per LED: 120 bytes for 24 + 12 LEDs,
+// 303 for 60 + 24 + 12. The ATmega328's EEPROM is 1 KB, so larger faces
+// need a lower address.
+#ifndef COLOR_CORRECTION_ADDRESS
+#define COLOR_CORRECTION_ADDRESS 768
+#endif
+
+// LED current model (WS2812B at 5V): mA per channel at full level, and
+// the quiescent draw of each LED
+#ifndef LED_MA_RED
+#define LED_MA_RED 20
+#endif
+
+#ifndef LED_MA_GREEN
+#define LED_MA_GREEN 20
+#endif
+
+#ifndef LED_MA_BLUE
+#define LED_MA_BLUE 20
+#endif
+
+#ifndef LED_MA_IDLE
+#define LED_MA_IDLE 1
+#endif
+
+// Ambient light defaults
+#ifndef AMBIENT_LIGHT_PIN
+#define AMBIENT_LIGHT_PIN A6
+#endif
+
+#ifndef AMBIENT_FILTER_SHIFT
+#define AMBIENT_FILTER_SHIFT 4     // EMA weight 1/16 per 65 ms block, about a second to settle
+#endif
+
+#ifndef AMBIENT_HYSTERESIS
+#define AMBIENT_HYSTERESIS 16      // Level change (of 1023) needed to report a new level
+#endif
+
+#ifndef AMBIENT_MIN_BRIGHTNESS
+#define AMBIENT_MIN_BRIGHTNESS 8   // Auto brightness in the dark
+#endif
+
 // Timing defaults
 #ifndef RTC_CHECK_DELAY
 #define RTC_CHECK_DELAY 50
 #endif
 
+#ifndef RTC_FAST_POLL_DELAY
+#define RTC_FAST_POLL_DELAY 4        // RTC poll spacing around the expected second rollover (seconds sweep)
+#endif
+
+#ifndef TARGET_FPS
+#define TARGET_FPS 30
+#endif
+
+#ifndef RENDER_BUDGET_PERCENT
+#define RENDER_BUDGET_PERCENT 50     // Share of the frame interval a pattern may take to render
+#endif
+
+#ifndef SECONDS_SWEEP_FPS
+#define SECONDS_SWEEP_FPS 15         // Lowest frame rate while the seconds dot sweeps
+#endif
+
+#ifndef QUIET_FPS_PERCENT
+#define QUIET_FPS_PERCENT 50         // Frame rate during quiet hours, as a share of the pattern's rate
+#endif
+
+// Pattern defaults
+#ifndef PATTERN_TRANSITION_TIME
+#define PATTERN_TRANSITION_TIME 3000
+#endif
+
+#ifndef PARTICLE_POOL_SIZE
+#define PARTICLE_POOL_SIZE 8
+#endif
+
 // Quiet hours defaults
 #ifndef QUIET_HOURS_START
 #define QUIET_HOURS_START 22
@@ -69,6 +152,23 @@
 #define QUIET_BRIGHTNESS_PERCENT 50
 #endif
 
+#ifndef QUIET_RAMP_MINUTES
+#define QUIET_RAMP_MINUTES 30        // Fade into and out of quiet hours over this long
+#endif
+
+// Output color balance at full quiet (of 255) - a warm white
+#ifndef QUIET_WARM_RED
+#define QUIET_WARM_RED 255
+#endif
+
+#ifndef QUIET_WARM_GREEN
+#define QUIET_WARM_GREEN 170
+#endif
+
+#ifndef QUIET_WARM_BLUE
+#define QUIET_WARM_BLUE 90
+#endif
+
 // Helper functions for quiet hours
 inline bool isQuietHours(int hour, int start = QUIET_HOURS_START, int end = QUIET_HOURS_END) {
     if (start > end) {
@@ -80,6 +180,29 @@ inline bool isQuietHours(int hour, int start = QUIET_HOURS_START, int end = QUIE
     }
 }
 
+// How far into quiet hours a time of day is, from 0 (normal) to 256
+// (fully quiet). Each change starts on the hour (start, then end) and
+// takes rampMinutes. It depends only on the time, so after a reset the
+// ramp carries on where it was.
+inline uint16_t getQuietLevel(int hour, int minute, int second, int start = QUIET_HOURS_START,
+                              int end = QUIET_HOURS_END, int rampMinutes = QUIET_RAMP_MINUTES) {
+    const int32_t day = 86400L;
+    int32_t now = hour * 3600L + minute * 60L + second;
+    int32_t sinceStart = (now - start * 3600L + day) % day;
+    int32_t length = ((end - start) * 3600L + day) % day;
+    int32_t ramp = rampMinutes * 60L;
+    
+    if (sinceStart < length) {
+        // Fading in (or fully quiet)
+        return sinceStart < ramp ? sinceStart * 256 / ramp : 256;
+    }
+    
+    // Fading out from wherever the fade in got to
+    int32_t peak = length < ramp ? length : ramp;
+    int32_t sinceEnd = sinceStart - length;
+    return sinceEnd < peak ? (peak - sinceEnd) * 256 / ramp : 0;
+}
+
 inline uint8_t getQuietBrightness(uint8_t defaultBrightness, int percent = QUIET_BRIGHTNESS_PERCENT) {
     return (defaultBrightness * percent) / 100;
 }
@@ -0,0 +1,127 @@
+#include "ClockCompositor.h"
+
+ClockCompositor::ClockCompositor(int ledCount, uint8_t* storage)
+    : ledCount(ledCount)
+    , buffer(storage)
+    , ownsBuffer(false) {
+    // Otherwise one allocation at startup, like the Adafruit_NeoPixel buffer
+    if (buffer == nullptr) {
+        buffer = (uint8_t*)malloc((uint16_t)LAYER_COUNT * ledCount * 3);
+        ownsBuffer = true;
+    }
+    if (buffer == nullptr) {
+        this->ledCount = 0;
+    }
+    clearAll();
+    
+    for (int layer = 0; layer < LAYER_COUNT; layer++) {
+        layerMode[layer] = BLEND_REPLACE;
+        layerOpacity[layer] = 255;
+        layerEnabled[layer] = true;
+    }
+}
+
+ClockCompositor::~ClockCompositor() {
+    if (ownsBuffer) {
+        free(buffer);
+    }
+}
+
+void ClockCompositor::setPixel(Layer layer, int index, uint32_t color) {
+    if (index < 0 || index >= ledCount) {
+        return;
+    }
+    uint8_t* p = layerPixel(layer, index);
+    p[0] = (uint8_t)(color >> 16);
+    p[1] = (uint8_t)(color >> 8);
+    p[2] = (uint8_t)color;
+}
+
+void ClockCompositor::blendPixel(Layer layer, int index, uint32_t color, uint16_t weight) {
+    if (index < 0 || index >= ledCount) {
+        return;
+    }
+    uint8_t* p = layerPixel(layer, index);
+    uint8_t src[3] = { (uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color };
+    for (int c = 0; c < 3; c++) {
+        p[c] = (src[c] * weight + p[c] * (256 - weight)) >> 8;
+    }
+}
+
+void ClockCompositor::addPixel(Layer layer, int index, uint32_t color) {
+    if (index < 0 || index >= ledCount) {
+        return;
+    }
+    uint8_t* p = layerPixel(layer, index);
+    uint8_t src[3] = { (uint8_t)(color >> 16), (uint8_t)(color >> 8), (uint8_t)color };
+    for (int c = 0; c < 3; c++) {
+        uint16_t sum = p[c] + src[c];
+        p[c] = sum > 255 ? 255 : sum;
+    }
+}
+
+void ClockCompositor::fill(Layer layer, uint32_t color, int first, int count) {
+    int end = min(first + count, ledCount);
+    for (int i = first; i < end; i++) {
+        setPixel(layer, i, color);
+    }
+}
+
+void ClockCompositor::clear(Layer layer) {
+    if (ledCount > 0) {
+        memset(layerPixel(layer, 0), 0, ledCount * 3);
+    }
+}
+
+void ClockCompositor::clearAll() {
+    if (ledCount > 0) {
+        memset(buffer, 0, (uint16_t)LAYER_COUNT * ledCount * 3);
+    }
+}
+
+void ClockCompositor::setBlendMode(Layer layer, BlendMode mode, uint8_t opacity) {
+    layerMode[layer] = mode;
+    layerOpacity[layer] = opacity;
+}
+
+void ClockCompositor::composePixel(int index, uint8_t& r, uint8_t& g, uint8_t& b) const {
+    const uint8_t* base = layerPixel(LAYER_BACKGROUND, index);
+    uint8_t out[3] = { base[0], base[1], base[2] };
+    
+    for (int layer = LAYER_BACKGROUND + 1; layer < LAYER_COUNT; layer++) {
+        if (!layerEnabled[layer]) {
+            continue;
+        }
+        
+        const uint8_t* src = layerPixel((Layer)layer, index);
+        if ((src[0] | src[1] | src[2]) == 0) {
+            continue; // Black is transparent on overlays
+        }
+        
+        // Opacity 0-255 as a 0-256 weight so 255 is exactly opaque
+        uint16_t weight = layerOpacity[layer] + (layerOpacity[layer] >> 7);
+        
+        switch (layerMode[layer]) {
+            case BLEND_ADD:
+                for (int c = 0; c < 3; c++) {
+                    uint16_t sum = out[c] + ((src[c] * weight) >> 8);
+                    out[c] = sum > 255 ? 255 : sum;
+                }
+                break;
+            case BLEND_ALPHA:
+                for (int c = 0; c < 3; c++) {
+                    out[c] = (src[c] * weight + out[c] * (256 - weight)) >> 8;
+                }
+                break;
+            default:
+                out[0] = src[0];
+                out[1] = src[1];
+                out[2] = src[2];
+                break;
+        }
+    }
+    
+    r = out[0];
+    g = out[1];
+    b = out[2];
+}
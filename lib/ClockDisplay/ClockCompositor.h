@@ -0,0 +1,75 @@
+#ifndef CLOCK_COMPOSITOR_H
+#define CLOCK_COMPOSITOR_H
+
+#include <Arduino.h>
+
+/**
+ * ClockCompositor - Layered framebuffer for the LED rings
+ * 
+ * Holds a fixed stack of RGB layers (background pattern, hour markers,
+ * transient effects) that are blended bottom to top into the output
+ * frame. Each layer keeps its contents between frames, so a layer only
+ * needs redrawing when it actually changes.
+ * 
+ * Overlay layers treat black pixels as transparent. The background
+ * layer is always drawn as-is.
+ */
+class ClockCompositor {
+public:
+    enum Layer {
+        LAYER_BACKGROUND = 0,
+        LAYER_MARKERS = 1,
+        LAYER_EFFECTS = 2,
+        LAYER_COUNT = 3
+    };
+    
+    enum BlendMode {
+        BLEND_REPLACE = 0,   // Lit pixels replace what is below
+        BLEND_ADD = 1,       // Saturating add, scaled by opacity
+        BLEND_ALPHA = 2      // Lit pixels mixed with what is below by opacity
+    };
+    
+    // Uses the given storage (LAYER_COUNT * ledCount * 3 bytes) when
+    // provided, otherwise allocates it
+    ClockCompositor(int ledCount, uint8_t* storage = nullptr);
+    ~ClockCompositor();
+    
+    // Drawing
+    void setPixel(Layer layer, int index, uint32_t color);
+    void fill(Layer layer, uint32_t color, int first, int count);
+    
+    // Mix a color into a layer pixel; weight 0-256 is the share of the new color
+    void blendPixel(Layer layer, int index, uint32_t color, uint16_t weight);
+    
+    // Saturating add of a color into a layer pixel
+    void addPixel(Layer layer, int index, uint32_t color);
+    void clear(Layer layer);
+    void clearAll();
+    
+    // Layer settings
+    void setBlendMode(Layer layer, BlendMode mode, uint8_t opacity = 255);
+    BlendMode getBlendMode(Layer layer) const { return (BlendMode)layerMode[layer]; }
+    uint8_t getOpacity(Layer layer) const { return layerOpacity[layer]; }
+    void setEnabled(Layer layer, bool enable) { layerEnabled[layer] = enable; }
+    bool isEnabled(Layer layer) const { return layerEnabled[layer]; }
+    
+    // Blend all enabled layers for one LED
+    void composePixel(int index, uint8_t& r, uint8_t& g, uint8_t& b) const;
+    
+    int getLedCount() const { return ledCount; }
+    
+private:
+    int ledCount;
+    uint8_t* buffer;   // LAYER_COUNT * ledCount * RGB
+    bool ownsBuffer;
+    
+    uint8_t layerMode[LAYER_COUNT];
+    uint8_t layerOpacity[LAYER_COUNT];
+    bool layerEnabled[LAYER_COUNT];
+    
+    uint8_t* layerPixel(Layer layer, int index) const {
+        return buffer + ((uint16_t)layer * ledCount + index) * 3;
+    }
+};
+
+#endif // CLOCK_COMPOSITOR_H
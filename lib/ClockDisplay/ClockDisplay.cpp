@@ -1,263 +1,1049 @@
 #include "ClockDisplay.h"
+#include <EEPROM.h>
+#include "FastTrig.h"
+#include "FastColor.h"
+#include "FastNoise.h"
+
+// Pattern descriptors, indexed by Pattern. Rates are 16-bit angle units
+// per millisecond in Q16.16: the original float rate in radians/ms
+// * 10430.378 * 65536. Angles: 16384 = quarter turn (sin -> cos).
+// Frame rates are what each pattern needs to look smooth: the full rate
+// for the fast ripple and embers, 5 fps for a hue that only drifts.
+static const PatternDescriptor PATTERN_DESCRIPTORS[ClockDisplay::PATTERN_COUNT] PROGMEM = {
+    // DEFAULT_COMPLEMENT - steady complementary rings
+    {
+        { 8, 8, 0, { WAVE_NONE, 0, 0, 0 }, 0, 0, { WAVE_NONE, 0, 0, 0 } },
+        { 127, 127, 0, { WAVE_NONE, 0, 0, 0 }, 32768U, 0, { WAVE_NONE, 0, 0, 0 } },
+        1024, 0, 5
+    },
+    // BREATHING_RINGS - sin(t/1000 * 0.5), sin(t/1000 * 0.3 + 1.5)
+    {
+        { 4, 8, 0, { WAVE_SINE, 341783L, 0, 0 }, 0, 0, { WAVE_NONE, 0, 0, 0 } },
+        { 60, 127, 0, { WAVE_SINE, 205070L, 15646U, 0 }, 32768U, 0, { WAVE_NONE, 0, 0, 0 } },
+        512, PATTERN_QUIET_BOOST, 15
+    },
+    // RIPPLE_EFFECT - sin(t/200 - distance * 0.8), sin(t/200 - distance * 1.2 + 1.0)
+    {
+        { 4, 8, RING_MIRRORED, { WAVE_SINE, 3417826L, 0, -8344L * 24 }, 0, 0, { WAVE_NONE, 0, 0, 0 } },
+        { 50, 130, RING_MIRRORED, { WAVE_SINE, 3417826L, 10430U, -12516L * 12 }, 32768U, 0, { WAVE_NONE, 0, 0, 0 } },
+        1024, PATTERN_QUIET_BOOST, 30
+    },
+    // SLOW_SPIRAL - one turn around each ring, t/3000 and t/2000;
+    // brightness follows cos, hue swings with sin (inner uses 80% of 60-100)
+    {
+        { 4, 8, 0, { WAVE_SINE, -227855L, 16384U, 65536L }, 0, 16384, { WAVE_SINE, -227855L, 0, 65536L } },
+        { 60, 92, 0, { WAVE_SINE, -341783L, 16384U, 65536L }, 32768U, 16384, { WAVE_SINE, -341783L, 0, 65536L } },
+        341, PATTERN_QUIET_BOOST, 15
+    },
+    // GENTLE_WAVES - one wave around each ring at t/2500, inner half a turn
+    // ahead (inner sin * 0.4 + 0.6 spans 81-127 of 70-127)
+    {
+        { 6, 8, 0, { WAVE_SINE, 273426L, 0, 65536L }, 0, 0, { WAVE_NONE, 0, 0, 0 } },
+        { 81, 127, 0, { WAVE_SINE, 273426L, 32768U, 65536L }, 32768U, 0, { WAVE_NONE, 0, 0, 0 } },
+        256, PATTERN_QUIET_BOOST, 15
+    },
+    // COLOR_DRIFT - t/8000 drift: outer hue sin(d + pi * pos), brightness
+    // sin(2d + 4 * pos); inner hue cos(0.7d + 1.5pi * pos), brightness
+    // cos(1.5d + 3 * pos) over 80% of 100-127
+    {
+        { 6, 8, 0, { WAVE_SINE, 170891L, 0, 41722L }, 0, 8192, { WAVE_SINE, 85446L, 0, 32768L } },
+        { 100, 122, 0, { WAVE_SINE, 128168L, 16384U, 31291L }, 32768U, 12288, { WAVE_SINE, 59812L, 16384U, 49152L } },
+        171, PATTERN_QUIET_BOOST, 10
+    },
+    // LIQUID_NOISE - slow blue-green currents: a noise cell drifts past
+    // about every 4 s, hue wanders +/- 30 degrees around cyan/blue
+    {
+        { 3, 8, 0, { WAVE_NOISE, 4194L, 0, 384L }, 38000U, 5461, { WAVE_NOISE, 2796L, 20000U, 256L } },
+        { 50, 127, 0, { WAVE_NOISE, 4194L, 40000U, 320L }, 42000U, 5461, { WAVE_NOISE, 2796L, 60000U, 256L } },
+        0, PATTERN_QUIET_BOOST | PATTERN_FIXED_HUE, 15
+    },
+    // CLOUD_NOISE - large soft patches of light drifting over the slowly
+    // cycling complementary hues, one cell every 8 s
+    {
+        { 4, 8, 0, { WAVE_NOISE, 2097L, 0, 192L }, 0, 0, { WAVE_NONE, 0, 0, 0 } },
+        { 40, 127, 0, { WAVE_NOISE, 2097L, 30000U, 256L }, 32768U, 0, { WAVE_NONE, 0, 0, 0 } },
+        128, PATTERN_QUIET_BOOST, 10
+    },
+    // EMBER_NOISE - warm red-orange glow, livelier than the others (a cell
+    // every 600 ms) but confined to fire colors
+    {
+        { 2, 8, 0, { WAVE_NOISE, 27962L, 0, 512L }, 1800U, 1800, { WAVE_NOISE, 13981L, 20000U, 384L } },
+        { 30, 127, 0, { WAVE_NOISE, 27962L, 40000U, 448L }, 2400U, 2400, { WAVE_NOISE, 13981L, 60000U, 384L } },
+        0, PATTERN_QUIET_BOOST | PATTERN_FIXED_HUE, 30
+    }
+};
+
+// Windmill hour change animation: 48 steps of 42 ms (about two seconds)
+#define WINDMILL_STEPS 48
+#define WINDMILL_STEP_TIME 42
+
+// Particle spawning: one every interval ms plus up to the same again
+#define TWINKLE_SPAWN_INTERVAL 200
+#define DROPLET_SPAWN_INTERVAL 400
+
+// Convert millis() to a 16-bit phase angle. The product wraps modulo
+// 2^32 and only bits 16-31 are kept, which is exactly the ideal angle
+// modulo one turn. Since 2^32 * rate is a whole number of turns, the
+// phase is also continuous when millis() itself wraps after 49.7 days.
+static inline uint16_t phaseFromMillis(uint32_t time, int32_t rate) {
+    return (uint16_t)((time * (uint32_t)rate) >> 16);
+}
+
+// Phase across a ring at an LED's angle: spread angle units per turn,
+// wrapping like phaseFromMillis (the PatternVM SPREAD op)
+static inline uint16_t phaseAtAngle(uint16_t angle, int32_t spread) {
+    return (uint16_t)(((uint32_t)angle * (uint32_t)spread) >> 16);
+}
+
+// Signed Q15 sample of a wave shape. Noise sampled this way is 1D along
+// the phase, which is what a ring with no spread (one color) needs.
+static inline int16_t waveSample(uint8_t shape, uint16_t angle) {
+    if (shape == WAVE_NOISE) {
+        return noiseToQ15(fastNoise8(angle));
+    }
+    if (shape == WAVE_TRIANGLE) {
+        return fastTri16(angle);
+    }
+    return fastSin16(angle);
+}
+
+// Signed Q15 noise at an LED: a point on a circle of the given radius
+// (noise units) whose centre has drifted to phase along x
+static inline int16_t noiseSample(uint16_t phase, uint16_t offset, int32_t radius,
+                                  int16_t ledCos, int16_t ledSin) {
+    uint16_t x = phase + (((int32_t)ledCos * radius) >> 15);
+    uint16_t y = offset + (((int32_t)ledSin * radius) >> 15);
+    return noiseToQ15(fastNoise8(x, y));
+}
 
 ClockDisplay::ClockDisplay(int pin, int hourLeds, int minuteLeds, uint8_t brightness)
-    : pixels(hourLeds + minuteLeds, pin, NEO_GRB + NEO_KHZ800)
-    , hourLeds(hourLeds)
-    , minuteLeds(minuteLeds)
-    , totalLeds(hourLeds + minuteLeds)
+    : ClockDisplay(pin, RingGeometry(hourLeds, minuteLeds), brightness, nullptr, nullptr, nullptr) {
+}
+
+ClockDisplay::ClockDisplay(int pin, const RingGeometry& geometry, uint8_t brightness)
+    : ClockDisplay(pin, geometry, brightness, nullptr, nullptr, nullptr) {
+}
+
+ClockDisplay::ClockDisplay(int pin, const RingGeometry& geometry, uint8_t brightness,
+                           uint8_t* layerStorage, uint8_t* ditherStorage, uint8_t* stripStorage)
+    : output(geometry.getLedCount(), pin, stripStorage)
+    , layers(geometry.getLedCount(), layerStorage)
+    , geometry(geometry)
+    , totalLeds(geometry.getLedCount())
     , currentPattern(DEFAULT_COMPLEMENT)
-    , currentHue(0)
-    , quietMode(false)
-    , patternStartTime(0) {
-    pixels.setBrightness(brightness);
+    , huePhase(0)
+    , quietLevel(0)
+    , brightness(brightness)
+    , gammaEnabled(false)
+    , ditherResidual(nullptr)
+    , ditherStorage(ditherStorage)
+    , ledCorrection(nullptr)
+    , powerBudget(0)
+    , estimatedMilliamps(0)
+    , outputMilliamps(0)
+    , peakMilliamps(0)
+    , limitedFrames(0)
+    , patternStartTime(0)
+    , lastHueTime(0)
+    , transitionFrom(DEFAULT_COMPLEMENT)
+    , transitionStartTime(0)
+    , transitionDuration(0)
+    , transitionWorstMicros(0)
+    , backgroundWeight(256)
+    , hueHeld(false)
+    , lastHueStep(0)
+    , programMicros(0)
+    , renderBudget(0)
+    , halfResolution(false)
+    , markersHour12(-1)
+    , activeEffect(EFFECT_NONE)
+    , effectStartTime(0)
+    , particleMode(PARTICLES_NONE)
+    , nextSpawnTime(0)
+    , lastShownChecksum(0)
+    , frameDirty(true)
+    , skippedShows(0) {
+    layers.setEnabled(ClockCompositor::LAYER_EFFECTS, false);
+    for (uint8_t ring = 0; ring < CLOCK_MAX_RINGS; ring++) {
+        ditherRing[ring] = false;
+    }
+    memset(ringCorrection, 255, sizeof(ringCorrection));
+    memset(patternCosts, 0, sizeof(patternCosts));
+}
+
+ClockDisplay::~ClockDisplay() {
+    if (ditherResidual != ditherStorage) {
+        free(ditherResidual);
+    }
+    free(ledCorrection);
 }
 
 void ClockDisplay::begin() {
-    pixels.begin();
-    pixels.clear();
-    pixels.show();
+    output.begin();
+    output.clear();
+    output.show();
     patternStartTime = millis();
+    lastHueTime = patternStartTime;
+    loadColorCorrection(COLOR_CORRECTION_ADDRESS);
 }
 
-void ClockDisplay::adjustBrightnessForQuietMode(uint8_t& outerMin, uint8_t& outerMax,
-                                                uint8_t& innerMin, uint8_t& innerMax) {
-    if (quietMode) {
-        // Double minimum brightness for visibility in quiet mode
-        outerMin = min(255, outerMin * 2);
-        outerMax = min(255, outerMax * 2);
-        innerMin = min(255, innerMin + 10);
+uint32_t ClockDisplay::frameChecksum() const {
+    // Two running 16-bit sums (Fletcher style, without the modulo) -
+    // position sensitive and only a few cycles per byte on AVR
+    const uint8_t* data = output.getBuffer();
+    uint16_t bytes = output.getLedCount() * 3;
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+    for (uint16_t i = 0; i < bytes; i++) {
+        sum1 += data[i];
+        sum2 += sum1;
     }
+    return ((uint32_t)sum2 << 16) | sum1;
 }
 
-void ClockDisplay::displayPattern(Pattern pattern) {
-    switch (pattern) {
-        case BREATHING_RINGS:
-            displayBreathingRings();
-            break;
-        case RIPPLE_EFFECT:
-            displayRippleEffect();
-            break;
-        case SLOW_SPIRAL:
-            displaySlowSpiral();
-            break;
-        case GENTLE_WAVES:
-            displayGentleWaves();
-            break;
-        case COLOR_DRIFT:
-            displayColorDrift();
-            break;
-        default:
-            displayDefaultComplement();
-            break;
+void ClockDisplay::clear() {
+    layers.clearAll();
+    markersHour12 = -1;
+}
+
+bool ClockDisplay::setDithering(uint8_t ring, bool enable) {
+    if (ring >= CLOCK_MAX_RINGS) {
+        return false;
     }
+    if (enable && ditherResidual == nullptr) {
+        ditherResidual = ditherStorage != nullptr ? ditherStorage : (uint8_t*)malloc(totalLeds * 3);
+        if (ditherResidual == nullptr) {
+            return false;
+        }
+        // Stagger the starting remainders so pixels at the same level
+        // don't all step up on the same frame
+        for (int i = 0; i < totalLeds * 3; i++) {
+            ditherResidual[i] = i * 73;
+        }
+    }
+    ditherRing[ring] = enable;
+    return true;
 }
 
-void ClockDisplay::displayDefaultComplement() {
-    pixels.fill(Adafruit_NeoPixel::ColorHSV(currentHue, 255, 8), 0, hourLeds);
-    pixels.fill(Adafruit_NeoPixel::ColorHSV(currentHue + 32768L, 255, 127), hourLeds, minuteLeds);
+bool ClockDisplay::isDithering() const {
+    for (uint8_t ring = 0; ring < geometry.getRingCount(); ring++) {
+        if (ditherRing[ring]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ClockDisplay::setRingCorrection(uint8_t ring, uint8_t red, uint8_t green, uint8_t blue) {
+    if (ring >= CLOCK_MAX_RINGS) {
+        return;
+    }
+    ringCorrection[ring][0] = red;
+    ringCorrection[ring][1] = green;
+    ringCorrection[ring][2] = blue;
+}
+
+bool ClockDisplay::setLedCorrection(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index < 0 || index >= totalLeds) {
+        return false;
+    }
+    if (ledCorrection == nullptr) {
+        ledCorrection = (uint8_t*)malloc(totalLeds * 3);
+        if (ledCorrection == nullptr) {
+            return false;
+        }
+        memset(ledCorrection, 255, totalLeds * 3);
+    }
+    uint8_t* gain = &ledCorrection[index * 3];
+    gain[0] = red;
+    gain[1] = green;
+    gain[2] = blue;
+    return true;
+}
+
+void ClockDisplay::clearColorCorrection() {
+    memset(ringCorrection, 255, sizeof(ringCorrection));
+    free(ledCorrection);
+    ledCorrection = nullptr;
+}
+
+uint16_t ClockDisplay::getColorCorrectionSize(bool perLed) const {
+    return sizeof(ColorCorrectionHeader) + geometry.getRingCount() * 3 + (perLed ? totalLeds * 3 : 0);
+}
+
+bool ClockDisplay::loadColorCorrection(int address) {
+    ColorCorrectionHeader header;
+    if (address < 0 || (uint32_t)address + sizeof(header) > EEPROM.length()) {
+        return false;
+    }
+    EEPROM.get(address, header);
+    if (header.magic[0] != COLOR_CORRECTION_MAGIC0 || header.magic[1] != COLOR_CORRECTION_MAGIC1) {
+        return false;
+    }
+    if (header.ringCount != geometry.getRingCount() ||
+        ((header.flags & COLOR_CORRECTION_PER_LED) && header.ledCount != totalLeds)) {
+        Serial.println("ClockDisplay: Color correction table doesn't match the rings, ignored");
+        return false;
+    }
+    
+    // A table that would run past the end can only be a stray match
+    if ((uint32_t)address + getColorCorrectionSize(header.flags & COLOR_CORRECTION_PER_LED) > EEPROM.length()) {
+        return false;
+    }
     
-    currentHue += 1024; // HUE_STEP
-    currentHue %= (5 * 65536); // MAX_HUE
+    clearColorCorrection();
+    int offset = address + sizeof(header);
+    for (uint8_t ring = 0; ring < header.ringCount; ring++) {
+        setRingCorrection(ring, EEPROM.read(offset), EEPROM.read(offset + 1), EEPROM.read(offset + 2));
+        offset += 3;
+    }
+    if (header.flags & COLOR_CORRECTION_PER_LED) {
+        for (int i = 0; i < totalLeds; i++) {
+            if (!setLedCorrection(i, EEPROM.read(offset), EEPROM.read(offset + 1), EEPROM.read(offset + 2))) {
+                Serial.println("ClockDisplay: No memory for the LED color correction table");
+                break;
+            }
+            offset += 3;
+        }
+    }
+    
+    Serial.print("ClockDisplay: Color correction loaded (");
+    Serial.print(header.flags & COLOR_CORRECTION_PER_LED ? "per LED" : "per ring");
+    Serial.println(")");
+    return true;
 }
 
-void ClockDisplay::displayBreathingRings() {
-    uint32_t time = millis();
-    float breathCycle = sin((time / 1000.0) * 0.5) * 0.5 + 0.5;
-    float breathCycle2 = sin((time / 1000.0) * 0.3 + 1.5) * 0.5 + 0.5;
+bool ClockDisplay::saveColorCorrection(int address) const {
+    // Writes past the end wrap around onto other settings
+    if (address < 0 || (uint32_t)address + getColorCorrectionSize(ledCorrection != nullptr) > EEPROM.length()) {
+        Serial.println("ClockDisplay: Color correction table doesn't fit in the EEPROM, not saved");
+        return false;
+    }
     
-    uint8_t outerMinBrightness = 4;
-    uint8_t outerMaxBrightness = 8;
-    uint8_t innerMinBrightness = 60;
-    uint8_t innerMaxBrightness = 127;
+    ColorCorrectionHeader header;
+    header.magic[0] = COLOR_CORRECTION_MAGIC0;
+    header.magic[1] = COLOR_CORRECTION_MAGIC1;
+    header.ringCount = geometry.getRingCount();
+    header.flags = ledCorrection != nullptr ? COLOR_CORRECTION_PER_LED : 0;
+    header.ledCount = totalLeds;
+    EEPROM.put(address, header);
     
-    adjustBrightnessForQuietMode(outerMinBrightness, outerMaxBrightness,
-                                innerMinBrightness, innerMaxBrightness);
+    // update() only writes bytes that changed, sparing the EEPROM
+    int offset = address + sizeof(header);
+    for (uint8_t ring = 0; ring < header.ringCount; ring++) {
+        for (uint8_t channel = 0; channel < 3; channel++) {
+            EEPROM.update(offset++, ringCorrection[ring][channel]);
+        }
+    }
+    if (ledCorrection != nullptr) {
+        for (int i = 0; i < totalLeds * 3; i++) {
+            EEPROM.update(offset++, ledCorrection[i]);
+        }
+    }
+    return true;
+}
+
+inline uint8_t ClockDisplay::outputLevel(uint8_t value, uint16_t scale, uint8_t* residual) const {
+    if (gammaEnabled) {
+        value = Adafruit_NeoPixel::gamma8(value);
+    }
     
-    uint8_t brightness1 = outerMinBrightness + (breathCycle * (outerMaxBrightness - outerMinBrightness));
-    uint8_t brightness2 = innerMinBrightness + (breathCycle2 * (innerMaxBrightness - innerMinBrightness));
+    // 8.8 fixed point: at most 255 * 256 + 255, so it can't overflow
+    uint16_t level = (uint16_t)value * scale;
+    if (residual != nullptr) {
+        level += *residual;
+        *residual = level & 0xFF;
+        return level >> 8;
+    }
     
-    pixels.fill(Adafruit_NeoPixel::ColorHSV(currentHue, 255, brightness1), 0, hourLeds);
-    pixels.fill(Adafruit_NeoPixel::ColorHSV(currentHue + 32768L, 255, brightness2), hourLeds, minuteLeds);
+    // Round rather than truncate so dim levels survive low brightness
+    return (level + 128) >> 8;
+}
+
+inline uint16_t ClockDisplay::warmScale(uint16_t scale, uint8_t warm) const {
+    // Channel scale moved from neutral toward warm by the quiet level
+    uint16_t balance = 256 - (((uint16_t)(255 - warm) * quietLevel) >> 8);
+    return ((uint32_t)scale * balance) >> 8;
+}
+
+void ClockDisplay::compose() {
+    // Nothing to draw into if the strip buffer couldn't be allocated
+    if (output.getBuffer() == nullptr) {
+        return;
+    }
+    
+    // Output stage: layers stay at full precision, brightness, color
+    // balance and gamma are applied only on the way to the strip
+    uint16_t scale = (uint16_t)brightness + 1;
+    uint16_t scaleRed = scale;
+    uint16_t scaleGreen = scale;
+    uint16_t scaleBlue = scale;
+    if (quietLevel != 0) {
+        scaleRed = warmScale(scale, QUIET_WARM_RED);
+        scaleGreen = warmScale(scale, QUIET_WARM_GREEN);
+        scaleBlue = warmScale(scale, QUIET_WARM_BLUE);
+    }
     
-    currentHue += 512; // HUE_STEP / 2
-    currentHue %= (5 * 65536);
+    // Channel level sums for the current estimate, gathered on the way
+    // through rather than in a second pass over the strip
+    uint32_t red = 0;
+    uint32_t green = 0;
+    uint32_t blue = 0;
+    
+    for (uint8_t ring = 0; ring < geometry.getRingCount(); ring++) {
+        int first = geometry.getRingFirst(ring);
+        int end = first + geometry.getRingSize(ring);
+        bool dither = ditherRing[ring];
+        
+        // Ring gains fold into the ring's scales, costing nothing per pixel
+        const uint8_t* ringGain = ringCorrection[ring];
+        uint16_t ringRed = ((uint32_t)scaleRed * (ringGain[0] + 1)) >> 8;
+        uint16_t ringGreen = ((uint32_t)scaleGreen * (ringGain[1] + 1)) >> 8;
+        uint16_t ringBlue = ((uint32_t)scaleBlue * (ringGain[2] + 1)) >> 8;
+        
+        for (int i = first; i < end; i++) {
+            uint8_t r, g, b;
+            layers.composePixel(i, r, g, b);
+            
+            uint16_t pixelRed = ringRed;
+            uint16_t pixelGreen = ringGreen;
+            uint16_t pixelBlue = ringBlue;
+            if (ledCorrection != nullptr) {
+                const uint8_t* gain = &ledCorrection[i * 3];
+                pixelRed = ((uint32_t)ringRed * (gain[0] + 1)) >> 8;
+                pixelGreen = ((uint32_t)ringGreen * (gain[1] + 1)) >> 8;
+                pixelBlue = ((uint32_t)ringBlue * (gain[2] + 1)) >> 8;
+            }
+            
+            if (dither) {
+                uint8_t* residual = &ditherResidual[i * 3];
+                r = outputLevel(r, pixelRed, residual);
+                g = outputLevel(g, pixelGreen, residual + 1);
+                b = outputLevel(b, pixelBlue, residual + 2);
+            } else {
+                r = outputLevel(r, pixelRed, nullptr);
+                g = outputLevel(g, pixelGreen, nullptr);
+                b = outputLevel(b, pixelBlue, nullptr);
+            }
+            output.setPixel(i, r, g, b);
+            red += r;
+            green += g;
+            blue += b;
+        }
+    }
+    
+    limitPower(red, green, blue);
 }
 
-void ClockDisplay::displayRippleEffect() {
-    uint32_t time = millis();
-    float ripplePhase = (time / 200.0);
+void ClockDisplay::limitPower(uint32_t red, uint32_t green, uint32_t blue) {
+    // Current that follows the levels, in mA, on top of the fixed idle draw
+    uint32_t idle = (uint32_t)LED_MA_IDLE * totalLeds;
+    uint32_t active = (red * LED_MA_RED + green * LED_MA_GREEN + blue * LED_MA_BLUE + 127) / 255;
     
-    uint8_t outerMinBrightness = 4;
-    uint8_t outerMaxBrightness = 8;
-    uint8_t innerMinBrightness = 50;
-    uint8_t innerMaxBrightness = 130;
+    estimatedMilliamps = min(idle + active, (uint32_t)0xFFFF);
+    peakMilliamps = max(peakMilliamps, estimatedMilliamps);
+    outputMilliamps = estimatedMilliamps;
+    if (powerBudget == 0 || estimatedMilliamps <= powerBudget) {
+        return;
+    }
     
-    adjustBrightnessForQuietMode(outerMinBrightness, outerMaxBrightness,
-                                innerMinBrightness, innerMaxBrightness);
+    // Scale every channel by the same factor so hues are kept. Rounding
+    // down keeps the result within the budget; this pass only runs on
+    // frames that are over it.
+    uint16_t factor = powerBudget > idle ? ((powerBudget - idle) << 8) / active : 0;
+    uint8_t* data = output.getBuffer();
+    uint16_t bytes = output.getLedCount() * 3;
+    for (uint16_t i = 0; i < bytes; i++) {
+        data[i] = ((uint16_t)data[i] * factor) >> 8;
+    }
+    outputMilliamps = idle + ((active * factor) >> 8);
+    limitedFrames++;
+}
+
+void ClockDisplay::show() {
+    compose();
     
-    for (int i = 0; i < hourLeds; i++) {
-        float distance = min(i, hourLeds - i);
-        float ripple = sin(ripplePhase - distance * 0.8) * 0.5 + 0.5;
-        uint8_t brightness = outerMinBrightness + (ripple * (outerMaxBrightness - outerMinBrightness));
-        pixels.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(currentHue, 255, brightness));
+    // Pushing a frame is slow (a WS2812 strip blocks interrupts for over
+    // a millisecond on 36 LEDs), so only do it when the frame differs
+    // from the last one shown
+    uint32_t checksum = frameChecksum();
+    if (!frameDirty && checksum == lastShownChecksum) {
+        skippedShows++;
+        return;
     }
     
-    for (int i = 0; i < minuteLeds; i++) {
-        float distance = min(i, minuteLeds - i);
-        float ripple = sin(ripplePhase - distance * 1.2 + 1.0) * 0.5 + 0.5;
-        uint8_t brightness = innerMinBrightness + (ripple * (innerMaxBrightness - innerMinBrightness));
-        pixels.setPixelColor(hourLeds + i, Adafruit_NeoPixel::ColorHSV(currentHue + 32768L, 255, brightness));
+    output.show();
+    lastShownChecksum = checksum;
+    frameDirty = false;
+}
+
+void ClockDisplay::adjustBrightnessForQuietMode(uint8_t& outerMin, uint8_t& outerMax,
+                                                uint8_t& innerMin, uint8_t& innerMax) {
+    if (quietLevel == 0) {
+        return;
     }
     
-    currentHue += 1024;
-    currentHue %= (5 * 65536);
+    // Double minimum brightness for visibility in quiet mode, blended in
+    // by the quiet level
+    outerMin += ((uint16_t)(min(255, outerMin * 2) - outerMin) * quietLevel) >> 8;
+    outerMax += ((uint16_t)(min(255, outerMax * 2) - outerMax) * quietLevel) >> 8;
+    innerMin += ((uint16_t)(min(255, innerMin + 10) - innerMin) * quietLevel) >> 8;
 }
 
-void ClockDisplay::displaySlowSpiral() {
-    uint32_t time = millis();
-    float spiralPhase1 = (time / 3000.0);
-    float spiralPhase2 = (time / 2000.0);
+void ClockDisplay::advanceHue(uint16_t stepPerSecond) {
+    // During a cross-fade displayPattern() advances the hue once, at a
+    // step blended between the two patterns'
+    lastHueStep = stepPerSecond;
+    if (hueHeld) {
+        return;
+    }
     
-    uint8_t outerMinBrightness = 4;
-    uint8_t outerMaxBrightness = 8;
-    uint8_t innerMinBrightness = 60;
-    uint8_t innerMaxBrightness = 100;
+    // Advance by the time since the last call rather than per frame, so
+    // the hue moves smoothly at the same speed at any frame rate
+    uint32_t now = millis();
+    uint32_t elapsed = now - lastHueTime;
+    lastHueTime = now;
     
-    adjustBrightnessForQuietMode(outerMinBrightness, outerMaxBrightness,
-                                innerMinBrightness, innerMaxBrightness);
+    // Hue units per ms in Q16.16 is stepPerSecond * 65.536 (8389 / 128).
+    // Overflow only discards whole turns, so the hue stays continuous.
+    uint32_t ratePerMs = ((uint32_t)stepPerSecond * 8389) >> 7;
+    huePhase += elapsed * ratePerMs;
+}
+
+void ClockDisplay::startTransition(Pattern from, uint16_t durationMs) {
+    transitionFrom = from;
+    transitionStartTime = millis();
+    transitionDuration = durationMs;
+    transitionWorstMicros = 0;
+}
+
+void ClockDisplay::displayPattern(Pattern pattern) {
+    currentPattern = pattern;
+    if (transitionDuration == 0) {
+        renderPattern(pattern);
+        return;
+    }
     
-    for (int i = 0; i < hourLeds; i++) {
-        float angle = (i * 2.0 * PI / hourLeds) - spiralPhase1;
-        uint32_t hue = currentHue + (sin(angle) * 16384L);
-        uint8_t brightness = outerMinBrightness + (cos(angle) * 0.5 + 0.5) * (outerMaxBrightness - outerMinBrightness);
-        pixels.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(hue, 255, brightness));
+    uint32_t elapsed = millis() - transitionStartTime;
+    if (elapsed >= transitionDuration) {
+        transitionDuration = 0;
+        Serial.print("ClockDisplay: Transition complete, worst dual-render frame ");
+        Serial.print(transitionWorstMicros);
+        Serial.println(" us");
+        renderPattern(pattern);
+        return;
     }
     
-    for (int i = 0; i < minuteLeds; i++) {
-        float angle = (i * 2.0 * PI / minuteLeds) - spiralPhase2;
-        uint32_t hue = (currentHue + 32768L) + (sin(angle) * 16384L);
-        uint8_t brightness = innerMinBrightness + (cos(angle) * 0.4 + 0.4) * (innerMaxBrightness - innerMinBrightness);
-        pixels.setPixelColor(hourLeds + i, Adafruit_NeoPixel::ColorHSV(hue, 255, brightness));
+    // Draw the outgoing pattern, then mix the incoming one over it in place
+    uint32_t start = micros();
+    hueHeld = true;
+    renderPattern(transitionFrom);
+    uint16_t fromHueStep = lastHueStep;
+    backgroundWeight = (elapsed * 256) / transitionDuration;
+    renderPattern(pattern);
+    
+    // Hue speed fades across with the colors
+    int32_t hueStepChange = (int32_t)lastHueStep - fromHueStep;
+    uint16_t hueStep = fromHueStep + ((hueStepChange * backgroundWeight) >> 8);
+    hueHeld = false;
+    backgroundWeight = 256;
+    advanceHue(hueStep);
+    
+    uint32_t cost = micros() - start;
+    if (cost > transitionWorstMicros) {
+        transitionWorstMicros = cost;
+    }
+}
+
+uint8_t ClockDisplay::getPatternFps(Pattern pattern) {
+    if (pattern < 0 || pattern >= PATTERN_COUNT) {
+        pattern = DEFAULT_COMPLEMENT;
+    }
+    return pgm_read_byte(&PATTERN_DESCRIPTORS[pattern].frameRate);
+}
+
+uint8_t ClockDisplay::getRequiredFps(uint8_t maxFps) const {
+    // Effects, cross-fades and particles move every frame, and dithering
+    // flickers rather than averaging out below the full rate
+    if (activeEffect != EFFECT_NONE || transitionDuration != 0 || particleMode != PARTICLES_NONE ||
+        isDithering()) {
+        return maxFps;
+    }
+    Pattern pattern = currentPattern < PATTERN_COUNT ? currentPattern : DEFAULT_COMPLEMENT;
+    uint8_t fps = getPatternFps(pattern);
+    if (patternCosts[pattern].tier >= QUALITY_HALF_RATE) {
+        fps = max(1, fps / 2);
+    }
+    return min(fps, maxFps);
+}
+
+void ClockDisplay::fillBackground(uint32_t color, int first, int count) {
+    if (backgroundWeight >= 256) {
+        layers.fill(ClockCompositor::LAYER_BACKGROUND, color, first, count);
+        return;
+    }
+    for (int i = first; i < first + count; i++) {
+        layers.blendPixel(ClockCompositor::LAYER_BACKGROUND, i, color, backgroundWeight);
+    }
+}
+
+void ClockDisplay::renderPattern(Pattern pattern) {
+    if (pattern < 0 || pattern >= PATTERN_COUNT) {
+        pattern = DEFAULT_COMPLEMENT;
     }
     
-    currentHue += 341; // HUE_STEP / 3
-    currentHue %= (5 * 65536);
+    halfResolution = patternCosts[pattern].tier >= QUALITY_HALF_RESOLUTION;
+    uint32_t start = micros();
+#ifdef CLOCK_PATTERN_VM
+    displayProgram((const uint8_t*)pgm_read_ptr(&PATTERN_PROGRAMS[pattern]));
+#else
+    displayDescriptor(&PATTERN_DESCRIPTORS[pattern]);
+#endif
+    recordPatternCost(pattern, micros() - start);
+    halfResolution = false;
 }
 
-void ClockDisplay::displayGentleWaves() {
-    uint32_t time = millis();
-    float wavePhase = (time / 2500.0);
+// Frames measured at a tier before the policy acts on its average
+#define COST_SETTLE_FRAMES 16
+
+void ClockDisplay::recordPatternCost(Pattern pattern, uint32_t micros) {
+    PatternCost& cost = patternCosts[pattern];
+    uint16_t sample = min(micros, (uint32_t)0xFFFF);
+    if (cost.frames == 0) {
+        cost.averageMicros = sample;
+        cost.peakMicros = sample;
+    } else {
+        cost.averageMicros += ((int32_t)sample - cost.averageMicros) >> 3;
+        cost.peakMicros -= cost.peakMicros >> 6;
+        cost.peakMicros = max(cost.peakMicros, sample);
+    }
+    if (cost.frames < 255) {
+        cost.frames++;
+    }
     
-    uint8_t outerMinBrightness = 6;
-    uint8_t outerMaxBrightness = 8;
-    uint8_t innerMinBrightness = 70;
-    uint8_t innerMaxBrightness = 127;
+    if (renderBudget == 0 || cost.frames < COST_SETTLE_FRAMES) {
+        return;
+    }
     
-    adjustBrightnessForQuietMode(outerMinBrightness, outerMaxBrightness,
-                                innerMinBrightness, innerMaxBrightness);
+    // Step down while over budget; step up only with room to spare, as
+    // the better tier costs about twice as much
+    uint8_t tier = cost.tier;
+    if (cost.averageMicros > renderBudget && tier < QUALITY_HALF_RATE) {
+        tier++;
+    } else if (tier > QUALITY_FULL && (uint32_t)cost.averageMicros * 3 < renderBudget) {
+        tier--;
+    } else {
+        return;
+    }
     
-    for (int i = 0; i < hourLeds; i++) {
-        float position = (float)i / hourLeds * 2.0 * PI;
-        float wave = sin(position + wavePhase) * 0.5 + 0.5;
-        uint8_t brightness = outerMinBrightness + (wave * (outerMaxBrightness - outerMinBrightness));
-        brightness = constrain(brightness, outerMinBrightness, outerMaxBrightness);
-        pixels.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(currentHue, 255, brightness));
+    Serial.print("ClockDisplay: Pattern ");
+    Serial.print(pattern);
+    Serial.print(" averages ");
+    Serial.print(cost.averageMicros);
+    Serial.print(" us of ");
+    Serial.print(renderBudget);
+    Serial.print(", quality tier ");
+    Serial.println(tier);
+    cost.tier = tier;
+    cost.frames = 0;
+}
+
+void ClockDisplay::printPatternCosts() const {
+    Serial.print("ClockDisplay: Render budget ");
+    Serial.print(renderBudget);
+    Serial.println(" us");
+    for (uint8_t pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+        const PatternCost& cost = patternCosts[pattern];
+        if (cost.frames == 0 && cost.tier == QUALITY_FULL) {
+            continue;
+        }
+        Serial.print("ClockDisplay: Pattern ");
+        Serial.print(pattern);
+        Serial.print(" avg ");
+        Serial.print(cost.averageMicros);
+        Serial.print(" us, peak ");
+        Serial.print(cost.peakMicros);
+        Serial.print(" us, tier ");
+        Serial.println(cost.tier);
     }
+}
+
+bool ClockDisplay::displayProgram(const uint8_t* program) {
+    PatternVM vm;
+    vm.load(program);
+    return renderProgram(vm);
+}
+
+bool ClockDisplay::displayProgramFromEeprom(int address) {
+    PatternVM vm;
+    vm.loadFromEeprom(address);
+    return renderProgram(vm);
+}
+
+bool ClockDisplay::renderProgram(const PatternVM& vm) {
+    if (!vm.isLoaded()) {
+        return false;
+    }
+    
+    uint32_t start = micros();
+    PatternVMContext context;
+    context.time = millis();
+    context.patternHue = currentHue();
+    context.quietLevel = quietLevel;
     
-    for (int i = 0; i < minuteLeds; i++) {
-        float position = (float)i / minuteLeds * 2.0 * PI;
-        float wave = sin(position + wavePhase + PI) * 0.4 + 0.6;
-        uint8_t brightness = innerMinBrightness + (wave * (innerMaxBrightness - innerMinBrightness));
-        brightness = constrain(brightness, innerMinBrightness, innerMaxBrightness);
-        pixels.setPixelColor(hourLeds + i, Adafruit_NeoPixel::ColorHSV(currentHue + 32768L, 255, brightness));
+    for (uint8_t ring = 0; ring < geometry.getRingCount(); ring++) {
+        int first = geometry.getRingFirst(ring);
+        int count = geometry.getRingSize(ring);
+        uint32_t color = 0;
+        for (int i = 0; i < count; i++) {
+            if (!halfResolution || !(i & 1)) {
+                color = vm.evaluate(ring & 1, i, count, geometry.getAngle(ring, i), context);
+            }
+            setBackgroundPixel(first + i, color);
+        }
     }
     
-    currentHue += 256; // HUE_STEP / 4
-    currentHue %= (5 * 65536);
+    advanceHue(vm.getHueStep());
+    programMicros = micros() - start;
+    return true;
 }
 
-void ClockDisplay::displayColorDrift() {
-    uint32_t time = millis();
-    float driftPhase = (time / 8000.0);
+void ClockDisplay::displayDescriptor(const PatternDescriptor* descriptor) {
+    PatternDescriptor d;
+    memcpy_P(&d, descriptor, sizeof(d));
     
-    uint8_t outerMinBrightness = 6;
-    uint8_t outerMaxBrightness = 8;
-    uint8_t innerMinBrightness = 100;
-    uint8_t innerMaxBrightness = 127;
+    uint8_t outerMinBrightness = d.outer.minBrightness;
+    uint8_t outerMaxBrightness = d.outer.maxBrightness;
+    uint8_t innerMinBrightness = d.inner.minBrightness;
+    uint8_t innerMaxBrightness = d.inner.maxBrightness;
     
-    adjustBrightnessForQuietMode(outerMinBrightness, outerMaxBrightness,
-                                innerMinBrightness, innerMaxBrightness);
+    if (d.flags & PATTERN_QUIET_BOOST) {
+        adjustBrightnessForQuietMode(outerMinBrightness, outerMaxBrightness,
+                                    innerMinBrightness, innerMaxBrightness);
+    }
     
-    for (int i = 0; i < hourLeds; i++) {
-        float position = (float)i / hourLeds;
-        uint32_t hue = currentHue + (sin(driftPhase + position * PI) * 8192L);
-        uint8_t brightness = outerMinBrightness + (sin(driftPhase * 2 + position * 4) * 0.5 + 0.5) * (outerMaxBrightness - outerMinBrightness);
-        pixels.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(hue, 255, brightness));
+    uint16_t patternHue = (d.flags & PATTERN_FIXED_HUE) ? 0 : currentHue();
+    uint32_t time = millis();
+    for (uint8_t ring = 0; ring < geometry.getRingCount(); ring++) {
+        if (ring & 1) {
+            renderRing(d.inner, ring, patternHue, innerMinBrightness, innerMaxBrightness, time);
+        } else {
+            renderRing(d.outer, ring, patternHue, outerMinBrightness, outerMaxBrightness, time);
+        }
     }
     
-    for (int i = 0; i < minuteLeds; i++) {
-        float position = (float)i / minuteLeds;
-        uint32_t hue = (currentHue + 32768L) + (cos(driftPhase * 0.7 + position * PI * 1.5) * 12288L);
-        uint8_t brightness = innerMinBrightness + (cos(driftPhase * 1.5 + position * 3) * 0.4 + 0.4) * (innerMaxBrightness - innerMinBrightness);
-        pixels.setPixelColor(hourLeds + i, Adafruit_NeoPixel::ColorHSV(hue, 255, brightness));
+    advanceHue(d.hueStep);
+}
+
+void ClockDisplay::renderRing(const RingDescriptor& ring, uint8_t ringIndex, uint16_t patternHue,
+                              uint8_t minBrightness, uint8_t maxBrightness, uint32_t time) {
+    int first = geometry.getRingFirst(ringIndex);
+    int count = geometry.getRingSize(ringIndex);
+    uint16_t baseHue = patternHue + ring.hueOffset;
+    uint8_t range = maxBrightness - minBrightness;
+    bool brightnessWave = ring.brightness.shape != WAVE_NONE;
+    bool hueWave = ring.hue.shape != WAVE_NONE && ring.hueAmplitude != 0;
+    
+    // A ring with no spatial variation is one color
+    if ((!brightnessWave || ring.brightness.spread == 0) && (!hueWave || ring.hue.spread == 0)) {
+        uint8_t brightness = maxBrightness;
+        if (brightnessWave) {
+            uint16_t angle = phaseFromMillis(time, ring.brightness.rate) + ring.brightness.offset;
+            brightness = minBrightness + fastScale8((uint16_t)((uint16_t)waveSample(ring.brightness.shape, angle) + 32767u) >> 8, range);
+        }
+        uint16_t hue = baseHue;
+        if (hueWave) {
+            uint16_t angle = phaseFromMillis(time, ring.hue.rate) + ring.hue.offset;
+            hue += ((int32_t)waveSample(ring.hue.shape, angle) * ring.hueAmplitude) >> 15;
+        }
+        fillBackground(fastHsv(hue, brightness), first, count);
+        return;
     }
     
-    currentHue += 171; // HUE_STEP / 6
-    currentHue %= (5 * 65536);
+    uint16_t brightnessPhase = phaseFromMillis(time, ring.brightness.rate) + ring.brightness.offset;
+    uint16_t huePhase = phaseFromMillis(time, ring.hue.rate) + ring.hue.offset;
+    bool mirrored = ring.flags & RING_MIRRORED;
+    bool brightnessNoise = ring.brightness.shape == WAVE_NOISE;
+    bool hueNoise = hueWave && ring.hue.shape == WAVE_NOISE;
+    
+    // Resolve the hue once when it is the same for the whole ring; per
+    // LED that leaves only the value scaling. Neighbouring LEDs often
+    // repeat a color, so the last conversion is reused when it matches.
+    HueColor ringHue = fastHue(baseHue);
+    uint16_t lastHue = baseHue;
+    uint8_t lastBrightness = 0;
+    uint32_t lastColor = 0;
+    bool haveLast = false;
+    
+    for (int i = 0; i < count; i++) {
+        if (halfResolution && (i & 1)) {
+            setBackgroundPixel(first + i, lastColor);
+            continue;
+        }
+        
+        // Waves are sampled at the LED's angle, so table geometries that
+        // don't start at 12 o'clock or space LEDs unevenly line up;
+        // mirrored rings use the distance from 12 o'clock
+        uint16_t ledAngle = geometry.getAngle(ringIndex, i);
+        uint16_t position = mirrored ? min(ledAngle, (uint16_t)-ledAngle) : ledAngle;
+        
+        // Noise waves share the LED's place on the sampling circle
+        int16_t ledCos = 0;
+        int16_t ledSin = 0;
+        if (brightnessNoise || hueNoise) {
+            ledCos = fastCos16(ledAngle);
+            ledSin = fastSin16(ledAngle);
+        }
+        
+        uint8_t brightness = maxBrightness;
+        if (brightnessNoise) {
+            int16_t sample = noiseSample(brightnessPhase, ring.brightness.offset, ring.brightness.spread, ledCos, ledSin);
+            brightness = minBrightness + fastScale8((uint16_t)((uint16_t)sample + 32767u) >> 8, range);
+        } else if (brightnessWave) {
+            uint16_t angle = brightnessPhase + phaseAtAngle(position, ring.brightness.spread);
+            brightness = minBrightness + fastScale8((uint16_t)((uint16_t)waveSample(ring.brightness.shape, angle) + 32767u) >> 8, range);
+        }
+        
+        uint16_t hue = baseHue;
+        if (hueNoise) {
+            int16_t sample = noiseSample(huePhase, ring.hue.offset, ring.hue.spread, ledCos, ledSin);
+            hue += ((int32_t)sample * ring.hueAmplitude) >> 15;
+        } else if (hueWave) {
+            uint16_t angle = huePhase + phaseAtAngle(position, ring.hue.spread);
+            hue += ((int32_t)waveSample(ring.hue.shape, angle) * ring.hueAmplitude) >> 15;
+        }
+        
+        if (!haveLast || hue != lastHue || brightness != lastBrightness) {
+            lastColor = hueWave ? fastHsv(hue, brightness) : fastScaleHue(ringHue, brightness);
+            lastHue = hue;
+            lastBrightness = brightness;
+            haveLast = true;
+        }
+        
+        setBackgroundPixel(first + i, lastColor);
+    }
+}
+
+void ClockDisplay::displayDefaultComplement() {
+    renderPattern(DEFAULT_COMPLEMENT);
+}
+
+void ClockDisplay::displayBreathingRings() {
+    renderPattern(BREATHING_RINGS);
+}
+
+void ClockDisplay::displayRippleEffect() {
+    renderPattern(RIPPLE_EFFECT);
+}
+
+void ClockDisplay::displaySlowSpiral() {
+    renderPattern(SLOW_SPIRAL);
+}
+
+void ClockDisplay::displayGentleWaves() {
+    renderPattern(GENTLE_WAVES);
+}
+
+void ClockDisplay::displayColorDrift() {
+    renderPattern(COLOR_DRIFT);
+}
+
+void ClockDisplay::displayLiquidNoise() {
+    renderPattern(LIQUID_NOISE);
+}
+
+void ClockDisplay::displayCloudNoise() {
+    renderPattern(CLOUD_NOISE);
+}
+
+void ClockDisplay::displayEmberNoise() {
+    renderPattern(EMBER_NOISE);
 }
 
 void ClockDisplay::showHourIndicators(int hour12) {
+    // The marker layer persists, so it is only redrawn when the hour changes
+    if (hour12 == markersHour12) {
+        return;
+    }
+    markersHour12 = hour12;
+    layers.clear(ClockCompositor::LAYER_MARKERS);
+    
+    uint32_t markerColor = Adafruit_NeoPixel::Color(128, 128, 128);
+    
+    // Markers go on the first ring, on the LED nearest each hour's angle
+    int first = geometry.getRingFirst(OUTER_RING);
+    
     // Light up LEDs for all hours from 1 through current hour (except 12)
     for (int i = 1; i < 12; i++) {
         if (i < hour12) {
-            pixels.setPixelColor(i * 2, pixels.Color(128, 128, 128));
+            uint16_t angle = (uint32_t)i * 65536 / 12;
+            layers.setPixel(ClockCompositor::LAYER_MARKERS, first + geometry.nearestLed(OUTER_RING, angle), markerColor);
         }
     }
     
     // Special case for 12 o'clock
     if (hour12 == 1) {
-        pixels.setPixelColor(0, pixels.Color(128, 128, 128));
+        layers.setPixel(ClockCompositor::LAYER_MARKERS, first + geometry.nearestLed(OUTER_RING, 0), markerColor);
     }
 }
 
-void ClockDisplay::showWindmillHourChange(int newHour) {
-    int rotationSteps = 48;
-    int stepDelay = 42;
+void ClockDisplay::showSecondsIndicator(uint16_t angle) {
+    if (geometry.getRingCount() <= INNER_RING) {
+        return;
+    }
     
-    for (int step = 0; step < rotationSteps; step++) {
-        pixels.clear();
-        
-        uint32_t rotationOffset = (step * 65535L / rotationSteps);
-        
-        // Outer ring: rainbow color field rotating clockwise
-        for (int i = 0; i < hourLeds; i++) {
-            uint32_t positionHue = (i * 65535L / hourLeds);
-            uint32_t hue = (positionHue - rotationOffset + 65536L) % 65536L;
-            uint8_t brightness = 35;
-            pixels.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(hue, 255, brightness));
+    uint32_t dotColor = Adafruit_NeoPixel::Color(255, 255, 255);
+    int first = geometry.getRingFirst(INNER_RING);
+    int count = geometry.getRingSize(INNER_RING);
+    uint16_t spacing = 65536UL / count;
+    
+    // Tent filter on the angular distance: an LED right at the dot takes
+    // its full color, fading out one LED spacing away. Works for unevenly
+    // spaced rings from a geometry table too.
+    for (int i = 0; i < count; i++) {
+        int16_t offset = geometry.getAngle(INNER_RING, i) - angle;
+        uint16_t distance = offset < 0 ? -(int32_t)offset : offset;
+        if (distance >= spacing) {
+            continue;
         }
-        
-        // Inner ring: synchronized rainbow at half speed
-        for (int i = 0; i < minuteLeds; i++) {
-            uint32_t positionHue = (i * 65535L / minuteLeds);
-            uint32_t hue = (positionHue - (rotationOffset / 2) + 65536L) % 65536L;
-            uint8_t brightness = 80;
-            pixels.setPixelColor(hourLeds + i, Adafruit_NeoPixel::ColorHSV(hue, 255, brightness));
+        uint16_t weight = ((uint32_t)(spacing - distance) << 8) / spacing;
+        layers.blendPixel(ClockCompositor::LAYER_BACKGROUND, first + i, dotColor, weight);
+    }
+}
+
+void ClockDisplay::startEffect(Effect effect) {
+    // A sequence may have drawn on the marker layer, and one that is
+    // replaced never gets cancelEffect(), so markers are redrawn here
+    timeline.stop();
+    markersHour12 = -1;
+    
+    activeEffect = effect;
+    effectStartTime = millis();
+    
+    layers.clear(ClockCompositor::LAYER_EFFECTS);
+    layers.setBlendMode(ClockCompositor::LAYER_EFFECTS, ClockCompositor::BLEND_REPLACE);
+    layers.setEnabled(ClockCompositor::LAYER_EFFECTS, effect != EFFECT_NONE);
+}
+
+void ClockDisplay::startTimeline(const TimelineSequence* sequence) {
+    startEffect(EFFECT_TIMELINE);
+    timeline.start(sequence, layers);
+}
+
+void ClockDisplay::cancelEffect() {
+    if (activeEffect == EFFECT_TIMELINE) {
+        // Sequences may draw on the marker layer too
+        timeline.stop();
+        markersHour12 = -1;
+    }
+    activeEffect = EFFECT_NONE;
+    layers.setEnabled(ClockCompositor::LAYER_EFFECTS, false);
+}
+
+bool ClockDisplay::renderEffect() {
+    if (activeEffect == EFFECT_NONE) {
+        return false;
+    }
+    
+    // Effects are timed from their start, so they run at the same speed
+    // whatever the frame rate and catch up after a slow frame
+    uint32_t elapsed = millis() - effectStartTime;
+    
+    switch (activeEffect) {
+        case EFFECT_WINDMILL: {
+            uint32_t step = elapsed / WINDMILL_STEP_TIME;
+            if (step >= WINDMILL_STEPS) {
+                cancelEffect();
+                return false;
+            }
+            renderWindmillFrame(step);
+            break;
         }
-        
-        pixels.show();
-        delay(stepDelay);
+        case EFFECT_TIMELINE:
+            if (!timeline.render(layers, geometry, currentHue(), elapsed)) {
+                cancelEffect();
+                return false;
+            }
+            break;
+        default:
+            cancelEffect();
+            return false;
     }
+    
+    return true;
 }
 
-void ClockDisplay::showQuarterHourEffect(float progress) {
-    if (progress >= 1.0) return;
+void ClockDisplay::setParticleMode(ParticleMode mode) {
+    particleMode = mode;
+    particles.clear();
+    nextSpawnTime = millis();
+    if (activeEffect == EFFECT_NONE) {
+        layers.setEnabled(ClockCompositor::LAYER_EFFECTS, false);
+    }
+}
+
+void ClockDisplay::renderParticles() {
+    // Effects own the effects layer while they run
+    if (activeEffect != EFFECT_NONE) {
+        return;
+    }
+    if (particleMode == PARTICLES_NONE && particles.getActiveCount() == 0) {
+        return;
+    }
+    
+    uint32_t now = millis();
+    particles.update(now);
+    
+    if (particleMode != PARTICLES_NONE && (int32_t)(now - nextSpawnTime) >= 0) {
+        uint16_t interval = particleMode == PARTICLES_TWINKLE ? TWINKLE_SPAWN_INTERVAL : DROPLET_SPAWN_INTERVAL;
+        nextSpawnTime = now + interval + random(interval);
+        spawnParticle();
+    }
+    
+    layers.clear(ClockCompositor::LAYER_EFFECTS);
+    layers.setBlendMode(ClockCompositor::LAYER_EFFECTS, ClockCompositor::BLEND_ADD);
+    layers.setEnabled(ClockCompositor::LAYER_EFFECTS, particles.getActiveCount() > 0);
+    particles.render(layers, ClockCompositor::LAYER_EFFECTS, geometry);
+}
+
+void ClockDisplay::spawnParticle() {
+    // Favour the dim outer-style (even) rings, where particles show best
+    uint8_t ring = random(geometry.getRingCount());
+    if ((ring & 1) && random(2) == 0) {
+        ring--;
+    }
+    bool outerStyle = (ring & 1) == 0;
+    int count = geometry.getRingSize(ring);
+    uint8_t level = outerStyle ? 48 : 160;
     
-    float bloomIntensity = sin(progress * PI) * 200;
+    if (particleMode == PARTICLES_TWINKLE) {
+        // Warm white, centred on an LED and still
+        uint16_t position = geometry.getAngle(ring, random(count));
+        uint32_t color = Adafruit_NeoPixel::Color(level, (level * 7) >> 3, (level * 5) >> 3);
+        particles.spawn(ring, position, 0, 1200 + random(1200), color);
+    } else {
+        // About a twelfth of a turn per 250 ms, outer-style rings at half speed
+        uint16_t position = random(0x10000L);
+        int16_t velocity = outerStyle ? 2796 : 5592;
+        uint32_t color = fastHsv(40000U + random(4096), level);
+        particles.spawn(ring, position, velocity, 2000 + random(1000), color);
+    }
+}
+
+void ClockDisplay::renderWindmillFrame(int step) {    
+    uint16_t rotationOffset = (uint32_t)step * 65536UL / WINDMILL_STEPS;
     
-    for (int i = 0; i < totalLeds; i++) {
-        uint8_t brightness = 20 + bloomIntensity;
-        brightness = constrain(brightness, 20, 220);
-        pixels.setPixelColor(i, Adafruit_NeoPixel::ColorHSV(currentHue, 180, brightness));
+    // Rainbow color field keyed to each LED's angle, rotating clockwise:
+    // outer-style rings at full speed, inner-style rings at half speed
+    for (uint8_t ring = 0; ring < geometry.getRingCount(); ring++) {
+        bool outerStyle = (ring & 1) == 0;
+        uint16_t rotation = outerStyle ? rotationOffset : rotationOffset / 2;
+        uint8_t brightness = outerStyle ? 35 : 80;
+        int first = geometry.getRingFirst(ring);
+        int count = geometry.getRingSize(ring);
+        for (int i = 0; i < count; i++) {
+            uint16_t hue = geometry.getAngle(ring, i) - rotation;
+            layers.setPixel(ClockCompositor::LAYER_EFFECTS, first + i, fastHsv(hue, brightness));
+        }
     }
 }
@@ -3,12 +3,51 @@
 
 #include <Arduino.h>
 #include <Adafruit_NeoPixel.h>
+#include "ClockCompositor.h"
+#include "ClockOutput.h"
+#include "PatternDescriptor.h"
+#include "ParticleSystem.h"
+#include "PatternVM.h"
+#include "RingGeometry.h"
+#include "Timeline.h"
+
+// Header of the color correction table in EEPROM. It is followed by an
+// R, G, B gain triple per ring, then one per LED if COLOR_CORRECTION_PER_LED
+// is set. Gains are 0-255, 255 = unchanged.
+#define COLOR_CORRECTION_MAGIC0 'C'
+#define COLOR_CORRECTION_MAGIC1 'C'
+#define COLOR_CORRECTION_PER_LED 0x01
+
+struct ColorCorrectionHeader {
+    uint8_t magic[2];
+    uint8_t ringCount;
+    uint8_t flags;
+    uint16_t ledCount;
+};
+
+// Render cost of one pattern, measured on every frame that draws it
+struct PatternCost {
+    uint16_t averageMicros;   // Moving average over about 8 frames
+    uint16_t peakMicros;      // Recent worst frame, decaying by 1/64 per frame
+    uint8_t frames;           // Frames measured at the current tier (saturates)
+    uint8_t tier;             // ClockDisplay::QualityTier
+};
 
 /**
  * ClockDisplay - Manages LED display patterns
  * 
  * Provides various display patterns for clock LED rings including
  * complementary colors, breathing, ripples, spirals, waves, and more.
+ * 
+ * Patterns draw into the background layer, hour indicators into the
+ * marker layer and effects into the effects layer; show() composites
+ * them into the LED strip through the ClockOutput backend chosen at
+ * build time (WS2812 by default, see ClockOutput.h).
+ * 
+ * The strip layout comes from a RingGeometry: any number of rings (up
+ * to CLOCK_MAX_RINGS), outermost first. Two-ring patterns alternate
+ * their outer and inner looks across the rings, so neighbouring rings
+ * stay complementary. Hour markers go on the first ring.
  */
 class ClockDisplay {
 public:
@@ -19,10 +58,46 @@ public:
         SLOW_SPIRAL = 3,
         GENTLE_WAVES = 4,
         COLOR_DRIFT = 5,
-        PATTERN_COUNT = 6
+        LIQUID_NOISE = 6,
+        CLOUD_NOISE = 7,
+        EMBER_NOISE = 8,
+        PATTERN_COUNT = 9
+    };
+    
+    // Names for the first two rings; further rings are numbered on
+    enum Ring {
+        OUTER_RING = 0,   // Hour LEDs, first on the strip
+        INNER_RING = 1    // Minute LEDs
+    };
+    
+    enum Effect {
+        EFFECT_NONE = 0,
+        EFFECT_WINDMILL = 1,
+        EFFECT_TIMELINE = 2   // A keyframed Timeline sequence
+    };
+    
+    // Cheaper ways to draw a pattern that doesn't fit the render budget
+    enum QualityTier {
+        QUALITY_FULL = 0,
+        QUALITY_HALF_RESOLUTION = 1,   // Odd LEDs repeat their neighbour
+        QUALITY_HALF_RATE = 2          // Half resolution and half the frame rate
+    };
+    
+    enum ParticleMode {
+        PARTICLES_NONE = 0,
+        PARTICLES_TWINKLE = 1,    // Stars fading in and out at random LEDs
+        PARTICLES_DROPLETS = 2    // Blue droplets sliding around the rings
     };
     
     ClockDisplay(int pin, int hourLeds, int minuteLeds, uint8_t brightness = 63);
+    ClockDisplay(int pin, const RingGeometry& geometry, uint8_t brightness = 63);
+    
+    // Use caller-provided buffers instead of the heap (see StaticClockDisplay).
+    // Any of them may be nullptr, in which case it is allocated (dither
+    // remainders on first use).
+    ClockDisplay(int pin, const RingGeometry& geometry, uint8_t brightness,
+                 uint8_t* layerStorage, uint8_t* ditherStorage, uint8_t* stripStorage);
+    ~ClockDisplay();
     
     // Initialize display
     void begin();
@@ -35,50 +110,279 @@ public:
     void displaySlowSpiral();
     void displayGentleWaves();
     void displayColorDrift();
+    void displayLiquidNoise();
+    void displayCloudNoise();
+    void displayEmberNoise();
+    
+    // Render any pattern described by a PatternDescriptor in PROGMEM
+    void displayDescriptor(const PatternDescriptor* descriptor);
+    
+    // Render a PatternVM program from PROGMEM or EEPROM; returns false
+    // (drawing nothing) if the program is malformed
+    bool displayProgram(const uint8_t* program);
+    bool displayProgramFromEeprom(int address);
+    
+    // Time (microseconds) of the last program frame
+    uint32_t getProgramMicros() const { return programMicros; }
+    
+    // Cross-fade from a previous pattern into whatever displayPattern()
+    // draws next, over durationMs (0 cuts immediately)
+    void startTransition(Pattern from, uint16_t durationMs);
+    bool isTransitionRunning() const { return transitionDuration != 0; }
+    
+    // Worst-case time (microseconds) of a frame that rendered two patterns
+    uint32_t getTransitionWorstMicros() const { return transitionWorstMicros; }
     
     // Show hour indicators (overlays on pattern)
     void showHourIndicators(int hour12);
     
-    // Special effects
-    void showWindmillHourChange(int newHour);
-    void showQuarterHourEffect(float progress);
+    // Seconds dot at angle (65536 = one turn) on the minute ring,
+    // anti-aliased across the two nearest LEDs. It is mixed into the
+    // pattern on the background layer, so call it after each
+    // displayPattern().
+    void showSecondsIndicator(uint16_t angle);
+    
+    // Special effects - non-blocking, one frame drawn per renderEffect() call
+    void startEffect(Effect effect);
+    void cancelEffect();
+    bool isEffectRunning() const { return activeEffect != EFFECT_NONE; }
+    Effect getActiveEffect() const { return activeEffect; }
+    
+    // Play a PROGMEM Timeline sequence as the running effect
+    void startTimeline(const TimelineSequence* sequence);
+    
+    // Whether the running effect covers the whole frame (the pattern can
+    // pause under it) rather than drawing over the pattern
+    bool isEffectFullFrame() const { return activeEffect == EFFECT_WINDMILL; }
+    
+    // Draw the running effect's current frame; returns false once it completes
+    bool renderEffect();
+    
+    // Particles - spawned, moved and drawn additively into the effects
+    // layer by renderParticles(), paused while an effect is running
+    void setParticleMode(ParticleMode mode);
+    ParticleMode getParticleMode() const { return particleMode; }
+    void renderParticles();
+    const ParticleSystem& getParticles() const { return particles; }
+    
+    // Display control - show() composites the layers and is skipped when
+    // the resulting frame is unchanged
+    void show();
+    void invalidate() { frameDirty = true; }
+    void clear();
+    void fill(uint32_t color) { fillBackground(color, 0, totalLeds); }
+    void setPixelColor(int index, uint32_t color) { setBackgroundPixel(index, color); }
+    
+    // Brightness control - applied in the output stage at show(), so
+    // changing it never touches the layer contents and is fully reversible
+    void setBrightness(uint8_t value) { brightness = value; }
+    uint8_t getBrightness() const { return brightness; }
     
-    // Display control
-    void show() { pixels.show(); }
-    void clear() { pixels.clear(); }
-    void fill(uint32_t color) { pixels.fill(color); }
+    // Power limiting - the output stage estimates each frame's LED current
+    // from the per-channel model in ClockConfig.h (LED_MA_*) and, when it
+    // exceeds the budget, scales the whole frame down to fit before show().
+    // A budget of 0 disables limiting; the estimate is always kept.
+    void setPowerBudget(uint16_t milliamps) { powerBudget = milliamps; }
+    uint16_t getPowerBudget() const { return powerBudget; }
     
-    // Brightness control
-    void setBrightness(uint8_t brightness) { pixels.setBrightness(brightness); }
-    uint8_t getBrightness() const { return pixels.getBrightness(); }
+    // Estimated current of the last frame as rendered and as sent to the
+    // strip (after limiting), the highest rendered estimate so far, and
+    // the number of frames that had to be scaled down
+    uint16_t getEstimatedMilliamps() const { return estimatedMilliamps; }
+    uint16_t getOutputMilliamps() const { return outputMilliamps; }
+    uint16_t getPeakMilliamps() const { return peakMilliamps; }
+    uint32_t getLimitedFrames() const { return limitedFrames; }
     
-    // Settings
+    // Share of the budget used by the last frame sent, in percent (0 with no budget)
+    uint8_t getPowerBudgetPercent() const {
+        return powerBudget ? (uint32_t)outputMilliamps * 100 / powerBudget : 0;
+    }
+    
+    // Gamma correction (NeoPixel PROGMEM gamma table) in the output stage
+    void setGammaCorrection(bool enable) { gammaEnabled = enable; }
+    bool isGammaCorrected() const { return gammaEnabled; }
+    
+    // Color correction - RGB gains (255 = unchanged) that even out LED
+    // batches, applied in the output stage. Ring gains fold into each
+    // ring's channel scales, so they cost nothing per pixel; a per-LED
+    // table adds three 8-bit multiply-shifts per pixel and 3 bytes of RAM
+    // per LED. begin() loads the table saved at COLOR_CORRECTION_ADDRESS.
+    // The saved table grows with the LED count (getColorCorrectionSize());
+    // load and save refuse a table that would run past the EEPROM's end.
+    void setRingCorrection(uint8_t ring, uint8_t red, uint8_t green, uint8_t blue);
+    bool setLedCorrection(int index, uint8_t red, uint8_t green, uint8_t blue);
+    void clearColorCorrection();
+    bool loadColorCorrection(int address = COLOR_CORRECTION_ADDRESS);
+    bool saveColorCorrection(int address = COLOR_CORRECTION_ADDRESS) const;
+    uint16_t getColorCorrectionSize(bool perLed) const;
+    
+    // Temporal dithering - carries each pixel's sub-LSB remainder into the
+    // next frame so dim levels average out between output steps. Works
+    // best at higher frame rates. Returns false if the buffer can't be allocated.
+    bool setDithering(uint8_t ring, bool enable);
+    bool isDithering(uint8_t ring) const { return ditherRing[ring]; }
+    bool isDithering() const;   // Any ring
+    
+    // Frame rate a pattern needs for smooth motion (from its descriptor)
+    static uint8_t getPatternFps(Pattern pattern);
+    
+    // Frame rate the display needs right now, up to maxFps: the current
+    // pattern's rate (halved at QUALITY_HALF_RATE), or maxFps while an
+    // effect, cross-fade or particles run, or while any ring dithers
+    // (the remainders only average out at a high frame rate)
+    uint8_t getRequiredFps(uint8_t maxFps) const;
+    
+    // Render budgeting - every pattern frame is timed. A pattern whose
+    // average cost exceeds the budget drops a quality tier; it steps back
+    // up once it averages under a third of the budget. 0 disables it.
+    void setRenderBudget(uint16_t micros) { renderBudget = micros; }
+    uint16_t getRenderBudget() const { return renderBudget; }
+    const PatternCost& getPatternCost(Pattern pattern) const { return patternCosts[pattern]; }
+    
+    // Print the measured cost of every pattern drawn so far
+    void printPatternCosts() const;
+    
+    // Settings - displayPattern() also makes its pattern current
     void setCurrentPattern(Pattern pattern) { currentPattern = pattern; }
     Pattern getCurrentPattern() const { return currentPattern; }
     
-    // Quiet hours support
-    void setQuietMode(bool quiet) { quietMode = quiet; }
-    bool isQuietMode() const { return quietMode; }
+    // Number of show() calls skipped because the frame was unchanged
+    uint32_t getSkippedShows() const { return skippedShows; }
+    
+    // Quiet hours support - the level (0 normal to 256 fully quiet) blends
+    // the patterns' quiet-mode levels in and warms the output color
+    // balance toward QUIET_WARM_RED/GREEN/BLUE, so quiet hours can fade in
+    void setQuietMode(bool quiet) { quietLevel = quiet ? 256 : 0; }
+    bool isQuietMode() const { return quietLevel != 0; }
+    void setQuietLevel(uint16_t level) { quietLevel = min(level, (uint16_t)256); }
+    uint16_t getQuietLevel() const { return quietLevel; }
     
-    // Access pixel strip
-    Adafruit_NeoPixel& getPixels() { return pixels; }
+    // Access layers, the ring layout and the output backend
+    ClockCompositor& getCompositor() { return layers; }
+    const RingGeometry& getGeometry() const { return geometry; }
+    ClockOutput& getOutput() { return output; }
     
 private:
-    Adafruit_NeoPixel pixels;
-    int hourLeds;
-    int minuteLeds;
+    ClockOutput output;
+    ClockCompositor layers;
+    RingGeometry geometry;
     int totalLeds;
     
     Pattern currentPattern;
-    uint32_t currentHue;
-    bool quietMode;
+    uint32_t huePhase;   // Q16.16 accumulator, the upper 16 bits are the hue
+    uint16_t quietLevel;
+    
+    // Output stage
+    uint8_t brightness;
+    bool gammaEnabled;
+    bool ditherRing[CLOCK_MAX_RINGS];
+    uint8_t* ditherResidual;   // Per-channel remainders, set up on first use
+    uint8_t* ditherStorage;    // Static remainder buffer, if provided
+    uint8_t ringCorrection[CLOCK_MAX_RINGS][3];
+    uint8_t* ledCorrection;    // Per-LED gains, allocated when first set
+    
+    // Power limiter
+    uint16_t powerBudget;
+    uint16_t estimatedMilliamps;
+    uint16_t outputMilliamps;
+    uint16_t peakMilliamps;
+    uint32_t limitedFrames;
     
     // Pattern state
     uint32_t patternStartTime;
+    uint32_t lastHueTime;
+    
+    // Pattern cross-fade
+    Pattern transitionFrom;
+    uint32_t transitionStartTime;
+    uint16_t transitionDuration;
+    uint32_t transitionWorstMicros;
+    uint16_t backgroundWeight;   // 256 writes directly, less blends into the layer
+    bool hueHeld;                // Set while a cross-fade renders both patterns
+    uint16_t lastHueStep;        // Hue step of the last pattern rendered
+    
+    uint32_t programMicros;
+    
+    // Render cost tracking
+    PatternCost patternCosts[PATTERN_COUNT];
+    uint16_t renderBudget;
+    bool halfResolution;   // Set while a degraded pattern renders
+    
+    // Hour shown on the marker layer (-1 when it needs redrawing)
+    int markersHour12;
+    
+    // Running effect
+    Effect activeEffect;
+    uint32_t effectStartTime;
+    Timeline timeline;
+    
+    // Particles
+    ParticleSystem particles;
+    ParticleMode particleMode;
+    uint32_t nextSpawnTime;
+    
+    // Dirty tracking
+    uint32_t lastShownChecksum;
+    bool frameDirty;
+    uint32_t skippedShows;
     
     // Helper methods
+    void advanceHue(uint16_t stepPerSecond);
+    uint16_t currentHue() const { return huePhase >> 16; }
+    void renderPattern(Pattern pattern);
+    void recordPatternCost(Pattern pattern, uint32_t micros);
+    bool renderProgram(const PatternVM& vm);
+    void renderRing(const RingDescriptor& ring, uint8_t ringIndex, uint16_t patternHue,
+                    uint8_t minBrightness, uint8_t maxBrightness, uint32_t time);
+    uint32_t frameChecksum() const;
+    void compose();
+    void limitPower(uint32_t red, uint32_t green, uint32_t blue);
+    uint8_t outputLevel(uint8_t value, uint16_t scale, uint8_t* residual) const;
+    uint16_t warmScale(uint16_t scale, uint8_t warm) const;
+    void setBackgroundPixel(int index, uint32_t color) {
+        if (backgroundWeight >= 256) {
+            layers.setPixel(ClockCompositor::LAYER_BACKGROUND, index, color);
+        } else {
+            layers.blendPixel(ClockCompositor::LAYER_BACKGROUND, index, color, backgroundWeight);
+        }
+    }
+    void fillBackground(uint32_t color, int first, int count);
+    void renderWindmillFrame(int step);
+    void spawnParticle();
     void adjustBrightnessForQuietMode(uint8_t& outerMin, uint8_t& outerMax,
                                      uint8_t& innerMin, uint8_t& innerMax);
 };
 
+/**
+ * StaticClockDisplay - ClockDisplay with compile-time sized buffers
+ * 
+ * The strip buffer, the compositor layers and optionally the dither
+ * remainders are statically allocated members instead of heap
+ * allocations, so they show up in the build's RAM report and can't fail
+ * or fragment at runtime: 12 bytes per LED, 15 with dithering (432 and
+ * 540 bytes for 24 + 12 LEDs). Behaves exactly like ClockDisplay
+ * otherwise; the render loops still take their bounds from the
+ * RingGeometry.
+ * 
+ *   StaticClockDisplay<24, 12> display(NEOPIXEL_PIN);
+ *   Clock clock(display);
+ */
+template<int ledCount, bool dither>
+struct ClockDisplayStorage {
+    uint8_t stripBuffer[ledCount * 3];
+    uint8_t layerBuffer[ClockCompositor::LAYER_COUNT * ledCount * 3];
+    uint8_t ditherBuffer[dither ? ledCount * 3 : 1];
+};
+
+template<int hourCount, int minuteCount, bool dither = false>
+class StaticClockDisplay : private ClockDisplayStorage<hourCount + minuteCount, dither>,
+                           public ClockDisplay {
+public:
+    // Storage is a base listed first, so it exists before ClockDisplay uses it
+    StaticClockDisplay(int pin, uint8_t brightness = 63)
+        : ClockDisplay(pin, RingGeometry(hourCount, minuteCount), brightness,
+                       this->layerBuffer, dither ? this->ditherBuffer : nullptr, this->stripBuffer) {
+    }
+};
+
 #endif // CLOCK_DISPLAY_H
@@ -0,0 +1,81 @@
+#include "ClockOutput.h"
+#include <SPI.h>
+
+// Caller-provided storage, or a zeroed heap buffer
+static uint8_t* stripBuffer(uint16_t ledCount, uint8_t* storage) {
+    if (storage == nullptr) {
+        return (uint8_t*)calloc(ledCount, 3);
+    }
+    memset(storage, 0, ledCount * 3);
+    return storage;
+}
+
+Apa102Output::Apa102Output(uint16_t ledCount, int pin, uint8_t* storage)
+    : buffer(stripBuffer(ledCount, storage))
+    , ledCount(buffer != nullptr ? ledCount : 0)
+    , ownsBuffer(storage == nullptr) {
+}
+
+Apa102Output::~Apa102Output() {
+    if (ownsBuffer) {
+        free(buffer);
+    }
+}
+
+void Apa102Output::begin() {
+    SPI.begin();
+}
+
+void Apa102Output::clear() {
+    memset(buffer, 0, ledCount * 3);
+}
+
+void Apa102Output::show() {
+    if (buffer == nullptr) {
+        return;
+    }
+    
+    SPI.beginTransaction(SPISettings(APA102_SPI_HZ, MSBFIRST, SPI_MODE0));
+    
+    // Start frame
+    for (uint8_t i = 0; i < 4; i++) {
+        SPI.transfer(0x00);
+    }
+    
+    // LED frames at full global brightness - the levels are already
+    // scaled by the output stage
+    const uint8_t* p = buffer;
+    for (uint16_t i = 0; i < ledCount; i++) {
+        SPI.transfer(0xFF);
+        SPI.transfer(p[0]);
+        SPI.transfer(p[1]);
+        SPI.transfer(p[2]);
+        p += 3;
+    }
+    
+    // End frame: SK9822 latches on 32 zero bits, and APA102 needs one more
+    // clock edge per two LEDs to push the data to the end of the strip
+    uint16_t endBytes = 4 + (ledCount + 15) / 16;
+    for (uint16_t i = 0; i < endBytes; i++) {
+        SPI.transfer(0x00);
+    }
+    
+    SPI.endTransaction();
+}
+
+NullOutput::NullOutput(uint16_t ledCount, int pin, uint8_t* storage)
+    : buffer(stripBuffer(ledCount, storage))
+    , ledCount(buffer != nullptr ? ledCount : 0)
+    , ownsBuffer(storage == nullptr)
+    , showCount(0) {
+}
+
+NullOutput::~NullOutput() {
+    if (ownsBuffer) {
+        free(buffer);
+    }
+}
+
+void NullOutput::clear() {
+    memset(buffer, 0, ledCount * 3);
+}
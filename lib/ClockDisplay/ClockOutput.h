@@ -0,0 +1,146 @@
+#ifndef CLOCK_OUTPUT_H
+#define CLOCK_OUTPUT_H
+
+#include <Arduino.h>
+#include <Adafruit_NeoPixel.h>
+#include <ClockConfig.h>
+
+/**
+ * ClockOutput - LED strip output backends
+ * 
+ * ClockDisplay's output stage writes each finished pixel into the
+ * backend's frame buffer with setPixel() and pushes the frame with
+ * show(). Patterns never see the backend: they draw into the
+ * ClockCompositor layers.
+ * 
+ * The backends share an interface by convention rather than through
+ * virtual methods, and ClockOutput names the one chosen by build flag,
+ * so setPixel() inlines into the compose loop:
+ * 
+ *   Ws2812Output  (default)             WS2812/NeoPixel via Adafruit_NeoPixel;
+ *                                       interrupts are off while it shows
+ *   Apa102Output  -DCLOCK_OUTPUT_APA102 APA102/SK9822 on the hardware SPI
+ *                                       pins (MOSI data, SCK clock); the pin
+ *                                       argument is unused
+ *   NullOutput    -DCLOCK_OUTPUT_NULL   Keeps the frame and sends nothing,
+ *                                       for benchmarks and host builds
+ * 
+ * The buffer holds 3 bytes per LED in the strip's wire order, so code
+ * that scales or checksums the whole frame doesn't need to know it.
+ * Backends use caller-provided storage (3 bytes per LED) when given
+ * some, and allocate it otherwise; it is nullptr if it couldn't be
+ * allocated.
+ */
+
+// Adafruit_NeoPixel on caller-provided pixel storage. The library has no
+// public way to do this, so the protected buffer fields are swapped
+// after construction and cleared again before its destructor frees them.
+class Ws2812Strip : public Adafruit_NeoPixel {
+public:
+    Ws2812Strip(uint16_t ledCount, int pin, uint8_t* storage)
+        : Adafruit_NeoPixel(storage != nullptr ? 0 : ledCount, pin, NEO_GRB + NEO_KHZ800)
+        , external(storage != nullptr) {
+        if (external) {
+            free(pixels);
+            memset(storage, 0, ledCount * 3);
+            pixels = storage;
+            numLEDs = ledCount;
+            numBytes = ledCount * 3;
+        }
+    }
+    ~Ws2812Strip() {
+        if (external) {
+            pixels = nullptr;
+        }
+    }
+    
+private:
+    bool external;
+};
+
+class Ws2812Output {
+public:
+    Ws2812Output(uint16_t ledCount, int pin, uint8_t* storage = nullptr)
+        : strip(ledCount, pin, storage) {
+        // Brightness is applied by ClockDisplay's output stage, so the
+        // strip's own (lossy, in-place) scaling is left at full
+        strip.setBrightness(255);
+    }
+    
+    void begin() { strip.begin(); }
+    void setPixel(uint16_t index, uint8_t r, uint8_t g, uint8_t b) {
+        uint8_t* p = strip.getPixels() + index * 3;
+        p[0] = g;
+        p[1] = r;
+        p[2] = b;
+    }
+    void clear() { strip.clear(); }
+    void show() { strip.show(); }
+    
+    uint8_t* getBuffer() const { return strip.getPixels(); }
+    uint16_t getLedCount() const { return strip.numPixels(); }
+    Adafruit_NeoPixel& getStrip() { return strip; }
+    
+private:
+    Ws2812Strip strip;
+};
+
+class Apa102Output {
+public:
+    Apa102Output(uint16_t ledCount, int pin, uint8_t* storage = nullptr);
+    ~Apa102Output();
+    
+    void begin();
+    void setPixel(uint16_t index, uint8_t r, uint8_t g, uint8_t b) {
+        uint8_t* p = buffer + index * 3;
+        p[0] = b;
+        p[1] = g;
+        p[2] = r;
+    }
+    void clear();
+    void show();
+    
+    uint8_t* getBuffer() const { return buffer; }
+    uint16_t getLedCount() const { return ledCount; }
+    
+private:
+    uint8_t* buffer;   // Blue, green, red per LED
+    uint16_t ledCount;
+    bool ownsBuffer;
+};
+
+class NullOutput {
+public:
+    NullOutput(uint16_t ledCount, int pin, uint8_t* storage = nullptr);
+    ~NullOutput();
+    
+    void begin() {}
+    void setPixel(uint16_t index, uint8_t r, uint8_t g, uint8_t b) {
+        uint8_t* p = buffer + index * 3;
+        p[0] = r;
+        p[1] = g;
+        p[2] = b;
+    }
+    void clear();
+    void show() { showCount++; }
+    
+    uint8_t* getBuffer() const { return buffer; }
+    uint16_t getLedCount() const { return ledCount; }
+    uint32_t getShowCount() const { return showCount; }
+    
+private:
+    uint8_t* buffer;   // Red, green, blue per LED
+    uint16_t ledCount;
+    bool ownsBuffer;
+    uint32_t showCount;
+};
+
+#if defined(CLOCK_OUTPUT_APA102)
+typedef Apa102Output ClockOutput;
+#elif defined(CLOCK_OUTPUT_NULL)
+typedef NullOutput ClockOutput;
+#else
+typedef Ws2812Output ClockOutput;
+#endif
+
+#endif // CLOCK_OUTPUT_H
@@ -0,0 +1,65 @@
+#ifndef FAST_COLOR_H
+#define FAST_COLOR_H
+
+#include <Arduino.h>
+
+/**
+ * FastColor - Integer HSV to RGB for fully saturated colors
+ * 
+ * Every pattern uses saturation 255, which lets the saturation terms
+ * of Adafruit_NeoPixel::ColorHSV() drop out. The conversion is split
+ * in two so a hue can be resolved once and then scaled to many values:
+ * 
+ *   HueColor base = fastHue(hue);          // once per distinct hue
+ *   uint32_t c = fastScaleHue(base, val);  // three 8x8 multiplies
+ * 
+ * Results are bit-identical to ColorHSV(hue, 255, val).
+ */
+
+struct HueColor {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+};
+
+// Fully saturated, full value color for a 16-bit hue
+inline HueColor fastHue(uint16_t hue) {
+    // Same 0-1530 mapping as ColorHSV (six 255-step segments)
+    uint16_t h = ((uint32_t)hue * 1530 + 32768) >> 16;
+    HueColor c;
+    
+    if (h < 510) {
+        c.b = 0;
+        if (h < 255) { c.r = 255; c.g = h; }
+        else { c.r = 510 - h; c.g = 255; }
+    } else if (h < 1020) {
+        c.r = 0;
+        if (h < 765) { c.g = 255; c.b = h - 510; }
+        else { c.g = 1020 - h; c.b = 255; }
+    } else if (h < 1530) {
+        c.g = 0;
+        if (h < 1275) { c.r = h - 1020; c.b = 255; }
+        else { c.r = 255; c.b = 1530 - h; }
+    } else {
+        c.r = 255;
+        c.g = 0;
+        c.b = 0;
+    }
+    
+    return c;
+}
+
+// Scale a resolved hue to a value and pack it as 0x00RRGGBB
+inline uint32_t fastScaleHue(const HueColor& c, uint8_t val) {
+    uint16_t v1 = (uint16_t)val + 1;
+    return ((uint32_t)((c.r * v1) >> 8) << 16) |
+           ((uint16_t)((c.g * v1) >> 8) << 8) |
+           ((c.b * v1) >> 8);
+}
+
+// Equivalent of ColorHSV(hue, 255, val)
+inline uint32_t fastHsv(uint16_t hue, uint8_t val) {
+    return fastScaleHue(fastHue(hue), val);
+}
+
+#endif // FAST_COLOR_H
@@ -0,0 +1,63 @@
+#ifndef FAST_NOISE_H
+#define FAST_NOISE_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+/**
+ * FastNoise - Integer-only 8-bit value noise
+ * 
+ * Coordinates are 8.8 fixed point: the high byte selects a lattice
+ * cell and the low byte is the position within it. Lattice values come
+ * from a 256-byte permutation table in PROGMEM, so the field repeats
+ * every 256 cells and 16-bit coordinates wrap seamlessly. Corners are
+ * blended with an 8-bit smoothstep; results are 0-255.
+ * 
+ * Cost per 2D sample: 6 PROGMEM byte reads and a handful of 8x8
+ * multiplies - no 32-bit math, no floats.
+ */
+
+extern const uint8_t NOISE_PERMUTATION[256] PROGMEM;
+
+inline uint8_t noiseHash(uint8_t x, uint8_t y) {
+    return pgm_read_byte(&NOISE_PERMUTATION[(uint8_t)(pgm_read_byte(&NOISE_PERMUTATION[x]) + y)]);
+}
+
+// Smoothstep 3t^2 - 2t^3 on 0-255
+inline uint8_t noiseEase(uint8_t t) {
+    uint16_t t2 = ((uint16_t)t * t) >> 8;
+    return (t2 * (768 - 2 * (uint16_t)t)) >> 8;
+}
+
+inline uint8_t noiseLerp(uint8_t a, uint8_t b, uint8_t t) {
+    if (b >= a) {
+        return a + (((uint16_t)(b - a) * t) >> 8);
+    }
+    return a - (((uint16_t)(a - b) * t) >> 8);
+}
+
+// 2D value noise
+inline uint8_t fastNoise8(uint16_t x, uint16_t y) {
+    uint8_t xi = x >> 8;
+    uint8_t yi = y >> 8;
+    uint8_t xf = noiseEase(x & 0xFF);
+    uint8_t yf = noiseEase(y & 0xFF);
+    
+    uint8_t top = noiseLerp(noiseHash(xi, yi), noiseHash(xi + 1, yi), xf);
+    uint8_t bottom = noiseLerp(noiseHash(xi, yi + 1), noiseHash(xi + 1, yi + 1), xf);
+    return noiseLerp(top, bottom, yf);
+}
+
+// 1D value noise
+inline uint8_t fastNoise8(uint16_t x) {
+    uint8_t xi = x >> 8;
+    return noiseLerp(noiseHash(xi, 0), noiseHash(xi + 1, 0), noiseEase(x & 0xFF));
+}
+
+// Noise sample as signed Q15, symmetric so that (q + 32767) >> 8 gives
+// the byte back
+inline int16_t noiseToQ15(uint8_t value) {
+    return ((int16_t)value - 128) * 256 + 127;
+}
+
+#endif // FAST_NOISE_H
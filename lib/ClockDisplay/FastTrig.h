@@ -0,0 +1,72 @@
+#ifndef FAST_TRIG_H
+#define FAST_TRIG_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+/**
+ * FastTrig - Fixed-point sine/cosine for LED patterns
+ * 
+ * The ATmega328 has no FPU, so float sin()/cos() cost thousands of
+ * cycles each. These helpers use a 257-entry quarter-wave table in
+ * PROGMEM with linear interpolation between entries.
+ * 
+ * Angles are 16-bit: 65536 units = one full turn (2*PI radians), so
+ * angle arithmetic wraps naturally (one radian is about 10430 units).
+ * Results are Q15 (-32767..32767).
+ * Worst-case error against float sin() is under 2/32767 (< 0.0001).
+ */
+
+#define FAST_SINE_TABLE_SIZE 256
+
+extern const uint16_t FAST_SINE_TABLE[FAST_SINE_TABLE_SIZE + 1] PROGMEM;
+
+// Sine of a 16-bit angle in Q15
+inline int16_t fastSin16(uint16_t angle) {
+    uint8_t quadrant = angle >> 14;
+    uint16_t offset = angle & 0x3FFF;
+    if (quadrant & 1) {
+        offset = 0x4000 - offset;
+    }
+    
+    // 64 angle units per table entry
+    uint16_t index = offset >> 6;
+    uint8_t fraction = offset & 0x3F;
+    uint16_t value = pgm_read_word(&FAST_SINE_TABLE[index]);
+    if (fraction) {
+        uint16_t next = pgm_read_word(&FAST_SINE_TABLE[index + 1]);
+        value += ((next - value) * fraction) >> 6;
+    }
+    
+    return (quadrant & 2) ? -(int16_t)value : (int16_t)value;
+}
+
+// Cosine of a 16-bit angle in Q15
+inline int16_t fastCos16(uint16_t angle) {
+    return fastSin16(angle + 0x4000);
+}
+
+// Triangle wave in Q15, peaks and troughs lined up with sine
+inline int16_t fastTri16(uint16_t angle) {
+    uint16_t a = angle + 0x4000;
+    uint16_t t = a < 0x8000 ? a : 0xFFFF - a;
+    return (int16_t)(t * 2 - 32767);
+}
+
+// Sine mapped to 0-255 (equivalent of sin(x) * 0.5 + 0.5)
+inline uint8_t fastWave8(uint16_t angle) {
+    // Bias in uint16_t: a positive sample + 32767 overflows a 16-bit int
+    return (uint16_t)((uint16_t)fastSin16(angle) + 32767u) >> 8;
+}
+
+// Cosine mapped to 0-255 (equivalent of cos(x) * 0.5 + 0.5)
+inline uint8_t fastCosWave8(uint16_t angle) {
+    return fastWave8(angle + 0x4000);
+}
+
+// Scale a 0-255 value into 0..range (255 maps exactly to range)
+inline uint8_t fastScale8(uint8_t value, uint8_t range) {
+    return ((uint16_t)(value + 1) * range) >> 8;
+}
+
+#endif // FAST_TRIG_H
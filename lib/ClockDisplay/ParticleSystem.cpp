@@ -0,0 +1,124 @@
+#include "ParticleSystem.h"
+
+#define PARTICLE_NONE 0xFF
+#define PARTICLE_ALIVE 0xFE
+
+static inline uint32_t scaledColor(const Particle& p, uint16_t weight) {
+    return ((uint32_t)((p.r * weight) >> 8) << 16) | ((uint16_t)((p.g * weight) >> 8) << 8) | ((p.b * weight) >> 8);
+}
+
+ParticleSystem::ParticleSystem()
+    : freeHead(PARTICLE_NONE)
+    , activeCount(0)
+    , peakCount(0)
+    , droppedSpawns(0)
+    , lastUpdate(0) {
+    clear();
+}
+
+void ParticleSystem::clear() {
+    // Chain every slot into the free list
+    for (uint8_t i = 0; i < PARTICLE_POOL_SIZE; i++) {
+        pool[i].next = i + 1 < PARTICLE_POOL_SIZE ? i + 1 : PARTICLE_NONE;
+    }
+    freeHead = PARTICLE_POOL_SIZE > 0 ? 0 : PARTICLE_NONE;
+    activeCount = 0;
+}
+
+bool ParticleSystem::spawn(uint8_t ring, uint16_t position, int16_t velocity,
+                           uint16_t lifetime, uint32_t color) {
+    if (freeHead == PARTICLE_NONE || ring >= CLOCK_MAX_RINGS || lifetime == 0) {
+        droppedSpawns++;
+        return false;
+    }
+    
+    Particle& p = pool[freeHead];
+    freeHead = p.next;
+    
+    p.position = position;
+    p.fraction = 0;
+    p.velocity = velocity;
+    p.age = 0;
+    p.lifetime = lifetime;
+    p.r = (uint8_t)(color >> 16);
+    p.g = (uint8_t)(color >> 8);
+    p.b = (uint8_t)color;
+    p.ring = ring;
+    p.next = PARTICLE_ALIVE;
+    
+    activeCount++;
+    if (activeCount > peakCount) {
+        peakCount = activeCount;
+    }
+    return true;
+}
+
+void ParticleSystem::release(uint8_t index) {
+    pool[index].next = freeHead;
+    freeHead = index;
+    activeCount--;
+}
+
+void ParticleSystem::update(uint32_t now) {
+    uint32_t elapsed = now - lastUpdate;
+    lastUpdate = now;
+    if (activeCount == 0) {
+        return;
+    }
+    
+    // Cap the step so a long pause just expires particles cleanly
+    uint16_t step = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+    
+    for (uint8_t i = 0; i < PARTICLE_POOL_SIZE; i++) {
+        Particle& p = pool[i];
+        if (p.next != PARTICLE_ALIVE) {
+            continue;
+        }
+        
+        if (step >= p.lifetime - p.age) {
+            release(i);
+            continue;
+        }
+        p.age += step;
+        
+        // Q8.8 distance, carrying the fraction between frames
+        int32_t moved = (int32_t)p.velocity * step + p.fraction;
+        p.position += (uint16_t)(moved >> 8);
+        p.fraction = moved & 0xFF;
+    }
+}
+
+void ParticleSystem::render(ClockCompositor& layers, ClockCompositor::Layer layer,
+                            const RingGeometry& geometry) const {
+    for (uint8_t i = 0; i < PARTICLE_POOL_SIZE; i++) {
+        const Particle& p = pool[i];
+        if (p.next != PARTICLE_ALIVE) {
+            continue;
+        }
+        if (p.ring >= geometry.getRingCount()) {
+            continue;
+        }
+        
+        // Envelope 0-256: quick rise over the first quarter, long fade
+        uint16_t quarter = p.lifetime >> 2;
+        uint16_t level;
+        if (p.age < quarter) {
+            level = ((uint32_t)p.age << 8) / quarter;
+        } else {
+            level = ((uint32_t)(p.lifetime - p.age) << 8) / (p.lifetime - quarter);
+        }
+        
+        // Split between the LEDs either side of the particle's angle
+        uint16_t next;
+        uint8_t share;
+        uint16_t led = geometry.locate(p.ring, p.position, next, share);
+        uint16_t nearWeight = ((uint32_t)level * (256 - share)) >> 8;
+        uint16_t farWeight = ((uint32_t)level * share) >> 8;
+        
+        int first = geometry.getRingFirst(p.ring);
+        layers.addPixel(layer, first + led, scaledColor(p, nearWeight));
+        if (farWeight > 0) {
+            layers.addPixel(layer, first + next, scaledColor(p, farWeight));
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <Arduino.h>
+#include <ClockConfig.h>
+#include "ClockCompositor.h"
+#include "RingGeometry.h"
+
+/**
+ * ParticleSystem - Short-lived sprites on the LED rings
+ * 
+ * Particles live in a fixed pool of PARTICLE_POOL_SIZE slots chained
+ * into a free list, so spawning and expiring are O(1) and nothing is
+ * ever allocated. When the pool is full a spawn is dropped (and
+ * counted) rather than failing the frame.
+ * 
+ * Position is a 16-bit angle around the particle's ring with an 8-bit
+ * fraction; velocity is angle units per millisecond in Q8.8. Brightness
+ * ramps up over the first quarter of the lifetime and fades out over
+ * the rest. Particles are drawn additively and anti-aliased across the
+ * two LEDs either side of their angle (from the RingGeometry, so table
+ * layouts place them correctly too).
+ */
+
+struct Particle {
+    uint16_t position;   // Angle around the ring
+    uint8_t fraction;    // Sub-unit position
+    int16_t velocity;    // Angle units per ms, Q8.8
+    uint16_t age;        // ms
+    uint16_t lifetime;   // ms
+    uint8_t r, g, b;     // Peak color
+    uint8_t ring;
+    uint8_t next;        // Free list link, or PARTICLE_ALIVE
+};
+
+class ParticleSystem {
+public:
+    ParticleSystem();
+    
+    // Returns false (and counts a dropped spawn) when the pool is full
+    bool spawn(uint8_t ring, uint16_t position, int16_t velocity,
+               uint16_t lifetime, uint32_t color);
+    void clear();
+    
+    // Move and age particles by the time since the last update
+    void update(uint32_t now);
+    
+    // Add every live particle into a compositor layer
+    void render(ClockCompositor& layers, ClockCompositor::Layer layer,
+                const RingGeometry& geometry) const;
+    
+    // Telemetry
+    uint8_t getActiveCount() const { return activeCount; }
+    uint8_t getPeakCount() const { return peakCount; }
+    uint8_t getPoolSize() const { return PARTICLE_POOL_SIZE; }
+    uint32_t getDroppedSpawns() const { return droppedSpawns; }
+    
+private:
+    Particle pool[PARTICLE_POOL_SIZE];
+    uint8_t freeHead;
+    uint8_t activeCount;
+    uint8_t peakCount;
+    uint32_t droppedSpawns;
+    uint32_t lastUpdate;
+    
+    void release(uint8_t index);
+};
+
+#endif // PARTICLE_SYSTEM_H
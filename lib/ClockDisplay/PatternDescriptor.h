@@ -0,0 +1,65 @@
+#ifndef PATTERN_DESCRIPTOR_H
+#define PATTERN_DESCRIPTOR_H
+
+#include <Arduino.h>
+
+/**
+ * PatternDescriptor - Compact, PROGMEM-resident pattern definition
+ * 
+ * A ring pattern is a hue and a brightness, each optionally driven by a
+ * wave sampled around the ring. For an LED at angle a (from the
+ * RingGeometry, 65536 = one turn) at time t:
+ * 
+ *   angle = t * rate + offset + a * spread / 65536   (16-bit angle units)
+ * 
+ * brightness sweeps minBrightness..maxBrightness with the wave, and the
+ * hue swings +/- hueAmplitude around the pattern hue plus hueOffset.
+ * One descriptor is about 60 bytes of flash.
+ * 
+ * WAVE_NOISE samples 2D value noise (FastNoise.h) on a circle instead,
+ * so the ring joins up seamlessly. The circle's centre drifts through
+ * the noise field at rate, offset moves it to an unrelated part of the
+ * field and spread is its radius in noise units (256 = one cell).
+ * Larger radii give more, smaller features around the ring.
+ */
+
+enum WaveShape {
+    WAVE_NONE = 0,       // Constant: brightness holds at max, hue is not modulated
+    WAVE_SINE = 1,
+    WAVE_TRIANGLE = 2,
+    WAVE_NOISE = 3
+};
+
+// Ring flags
+#define RING_MIRRORED 0x01   // Position is the angle from 12 o'clock either way, so the wave is symmetric about 12 o'clock
+
+// Pattern flags
+#define PATTERN_QUIET_BOOST 0x01   // Raise dim levels in quiet mode so the rings stay visible
+#define PATTERN_FIXED_HUE 0x02     // hueOffset is an absolute hue, the cycling pattern hue is ignored
+
+struct WaveDescriptor {
+    uint8_t shape;       // WaveShape
+    int32_t rate;        // Angle units per millisecond, Q16.16 (negative runs counterclockwise)
+    uint16_t offset;     // Angle units added to the phase
+    int32_t spread;      // Angle units across the whole ring
+};
+
+struct RingDescriptor {
+    uint8_t minBrightness;
+    uint8_t maxBrightness;
+    uint8_t flags;
+    WaveDescriptor brightness;
+    uint16_t hueOffset;
+    int16_t hueAmplitude;   // Hue units at the wave peak
+    WaveDescriptor hue;
+};
+
+struct PatternDescriptor {
+    RingDescriptor outer;
+    RingDescriptor inner;
+    uint16_t hueStep;       // Pattern hue advance per second
+    uint8_t flags;
+    uint8_t frameRate;      // Frames per second needed for smooth motion
+};
+
+#endif // PATTERN_DESCRIPTOR_H
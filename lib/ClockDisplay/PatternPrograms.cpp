@@ -0,0 +1,117 @@
+#include "PatternVM.h"
+
+// The built-in patterns as PatternVM programs, equivalent to the
+// PATTERN_DESCRIPTORS table in ClockDisplay.cpp. Per-LED phases come
+// from the LED's angle, so they fit any RingGeometry. Quiet mode
+// levels follow adjustBrightnessForQuietMode(): outer min and max
+// doubled, inner min + 10.
+
+static const uint8_t PROGRAM_DEFAULT_COMPLEMENT[] PROGMEM = {
+    VM_HEADER(1024),
+    // Outer
+    VM_OP_HUE, VM_PUSH8(8), VM_OP_HSV,
+    // Inner
+    VM_OP_HUE, VM_PUSH16(32768), VM_OP_ADD, VM_PUSH8(127), VM_OP_HSV
+};
+
+static const uint8_t PROGRAM_BREATHING_RINGS[] PROGMEM = {
+    VM_HEADER(512),
+    VM_OP_HUE,
+    VM_PHASE(341783L), VM_OP_SIN, VM_QUIET8(4, 8), VM_QUIET8(8, 16), VM_OP_LEVEL,
+    VM_OP_HSV,
+
+    VM_OP_HUE, VM_PUSH16(32768), VM_OP_ADD,
+    VM_PHASE(205070L), VM_PUSH16(15646), VM_OP_ADD, VM_OP_SIN, VM_QUIET8(60, 70), VM_PUSH8(127), VM_OP_LEVEL,
+    VM_OP_HSV
+};
+
+static const uint8_t PROGRAM_RIPPLE_EFFECT[] PROGMEM = {
+    VM_HEADER(1024),
+    VM_OP_HUE,
+    VM_PHASE(3417826L), VM_OP_ANGLE, VM_OP_FOLD, VM_SPREAD(-8344L * 24), VM_OP_ADD, VM_OP_SIN,
+    VM_QUIET8(4, 8), VM_QUIET8(8, 16), VM_OP_LEVEL,
+    VM_OP_HSV,
+
+    VM_OP_HUE, VM_PUSH16(32768), VM_OP_ADD,
+    VM_PHASE(3417826L), VM_PUSH16(10430), VM_OP_ADD, VM_OP_ANGLE, VM_OP_FOLD, VM_SPREAD(-12516L * 12), VM_OP_ADD, VM_OP_SIN,
+    VM_QUIET8(50, 60), VM_PUSH8(130), VM_OP_LEVEL,
+    VM_OP_HSV
+};
+
+static const uint8_t PROGRAM_SLOW_SPIRAL[] PROGMEM = {
+    VM_HEADER(341),
+    VM_OP_HUE, VM_WAVE(-227855L, 0, 65536L), VM_PUSH16(16384), VM_OP_MULQ, VM_OP_ADD,
+    VM_WAVE(-227855L, 16384, 65536L), VM_QUIET8(4, 8), VM_QUIET8(8, 16), VM_OP_LEVEL,
+    VM_OP_HSV,
+
+    VM_OP_HUE, VM_PUSH16(32768), VM_OP_ADD, VM_WAVE(-341783L, 0, 65536L), VM_PUSH16(16384), VM_OP_MULQ, VM_OP_ADD,
+    VM_WAVE(-341783L, 16384, 65536L), VM_QUIET8(60, 70), VM_PUSH8(92), VM_OP_LEVEL,
+    VM_OP_HSV
+};
+
+static const uint8_t PROGRAM_GENTLE_WAVES[] PROGMEM = {
+    VM_HEADER(256),
+    VM_OP_HUE,
+    VM_WAVE(273426L, 0, 65536L), VM_QUIET8(6, 12), VM_QUIET8(8, 16), VM_OP_LEVEL,
+    VM_OP_HSV,
+
+    VM_OP_HUE, VM_PUSH16(32768), VM_OP_ADD,
+    VM_WAVE(273426L, 32768, 65536L), VM_QUIET8(81, 91), VM_PUSH8(127), VM_OP_LEVEL,
+    VM_OP_HSV
+};
+
+static const uint8_t PROGRAM_COLOR_DRIFT[] PROGMEM = {
+    VM_HEADER(171),
+    VM_OP_HUE, VM_WAVE(85446L, 0, 32768L), VM_PUSH16(8192), VM_OP_MULQ, VM_OP_ADD,
+    VM_WAVE(170891L, 0, 41722L), VM_QUIET8(6, 12), VM_QUIET8(8, 16), VM_OP_LEVEL,
+    VM_OP_HSV,
+
+    VM_OP_HUE, VM_PUSH16(32768), VM_OP_ADD, VM_WAVE(59812L, 16384, 49152L), VM_PUSH16(12288), VM_OP_MULQ, VM_OP_ADD,
+    VM_WAVE(128168L, 16384, 31291L), VM_QUIET8(100, 110), VM_PUSH8(122), VM_OP_LEVEL,
+    VM_OP_HSV
+};
+
+static const uint8_t PROGRAM_LIQUID_NOISE[] PROGMEM = {
+    VM_HEADER(0),
+    VM_PUSH16(38000), VM_NOISE(2796L, 20000, 256), VM_PUSH16(5461), VM_OP_MULQ, VM_OP_ADD,
+    VM_NOISE(4194L, 0, 384), VM_QUIET8(3, 6), VM_QUIET8(8, 16), VM_OP_LEVEL,
+    VM_OP_HSV,
+
+    VM_PUSH16(42000), VM_NOISE(2796L, 60000, 256), VM_PUSH16(5461), VM_OP_MULQ, VM_OP_ADD,
+    VM_NOISE(4194L, 40000, 320), VM_QUIET8(50, 60), VM_PUSH8(127), VM_OP_LEVEL,
+    VM_OP_HSV
+};
+
+static const uint8_t PROGRAM_CLOUD_NOISE[] PROGMEM = {
+    VM_HEADER(128),
+    VM_OP_HUE,
+    VM_NOISE(2097L, 0, 192), VM_QUIET8(4, 8), VM_QUIET8(8, 16), VM_OP_LEVEL,
+    VM_OP_HSV,
+
+    VM_OP_HUE, VM_PUSH16(32768), VM_OP_ADD,
+    VM_NOISE(2097L, 30000, 256), VM_QUIET8(40, 50), VM_PUSH8(127), VM_OP_LEVEL,
+    VM_OP_HSV
+};
+
+static const uint8_t PROGRAM_EMBER_NOISE[] PROGMEM = {
+    VM_HEADER(0),
+    VM_PUSH16(1800), VM_NOISE(13981L, 20000, 384), VM_PUSH16(1800), VM_OP_MULQ, VM_OP_ADD,
+    VM_NOISE(27962L, 0, 512), VM_QUIET8(2, 4), VM_QUIET8(8, 16), VM_OP_LEVEL,
+    VM_OP_HSV,
+
+    VM_PUSH16(2400), VM_NOISE(13981L, 60000, 384), VM_PUSH16(2400), VM_OP_MULQ, VM_OP_ADD,
+    VM_NOISE(27962L, 40000, 448), VM_QUIET8(30, 40), VM_PUSH8(127), VM_OP_LEVEL,
+    VM_OP_HSV
+};
+
+const uint8_t* const PATTERN_PROGRAMS[] PROGMEM = {
+    PROGRAM_DEFAULT_COMPLEMENT,
+    PROGRAM_BREATHING_RINGS,
+    PROGRAM_RIPPLE_EFFECT,
+    PROGRAM_SLOW_SPIRAL,
+    PROGRAM_GENTLE_WAVES,
+    PROGRAM_COLOR_DRIFT,
+    PROGRAM_LIQUID_NOISE,
+    PROGRAM_CLOUD_NOISE,
+    PROGRAM_EMBER_NOISE
+};
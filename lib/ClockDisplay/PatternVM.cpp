@@ -0,0 +1,217 @@
+#include "PatternVM.h"
+#include <EEPROM.h>
+#include "FastTrig.h"
+#include "FastNoise.h"
+#include "FastColor.h"
+
+// Operand bytes and stack effect of each op
+struct PatternOpInfo {
+    uint8_t operands;
+    uint8_t pops;
+    uint8_t pushes;
+};
+
+static const PatternOpInfo PATTERN_OP_INFO[VM_OP_COUNT] PROGMEM = {
+    { 0, 2, 0 },   // HSV
+    { 1, 0, 1 },   // PUSH8
+    { 2, 0, 1 },   // PUSH16
+    { 4, 0, 1 },   // PHASE
+    { 0, 0, 1 },   // INDEX
+    { 0, 0, 1 },   // MIRROR
+    { 0, 0, 1 },   // ANGLE
+    { 0, 0, 1 },   // HUE
+    { 0, 2, 1 },   // ADD
+    { 0, 2, 1 },   // SUB
+    { 0, 2, 1 },   // MUL
+    { 0, 2, 1 },   // MULQ
+    { 0, 1, 1 },   // SIN
+    { 0, 1, 1 },   // COS
+    { 0, 1, 1 },   // TRI
+    { 0, 1, 1 },   // NOISE
+    { 0, 2, 1 },   // NOISE2
+    { 0, 3, 1 },   // LEVEL
+    { 0, 2, 1 },   // QUIET
+    { 0, 1, 2 },   // DUP
+    { 0, 2, 2 },   // SWAP
+    { 4, 1, 1 },   // SPREAD
+    { 0, 1, 1 }    // FOLD
+};
+
+PatternVM::PatternVM()
+    : program(nullptr)
+    , eepromAddress(0)
+    , fromEeprom(false)
+    , loaded(false)
+    , hueStep(0)
+    , length(0) {
+    ringStart[0] = 0;
+    ringStart[1] = 0;
+}
+
+bool PatternVM::load(const uint8_t* progmemProgram) {
+    program = progmemProgram;
+    fromEeprom = false;
+    loaded = program != nullptr && validate();
+    return loaded;
+}
+
+bool PatternVM::loadFromEeprom(int address) {
+    program = nullptr;
+    eepromAddress = address;
+    fromEeprom = true;
+    loaded = address >= 0 && validate();
+    return loaded;
+}
+
+inline uint8_t PatternVM::fetch(uint16_t offset) const {
+    if (fromEeprom) {
+        return EEPROM.read(eepromAddress + offset);
+    }
+    return pgm_read_byte(program + offset);
+}
+
+bool PatternVM::validate() {
+    hueStep = fetch(0) | ((uint16_t)fetch(1) << 8);
+
+    // Walk both ring programs, tracking the stack depth
+    uint16_t pc = 2;
+    for (uint8_t ring = 0; ring < 2; ring++) {
+        ringStart[ring] = pc;
+        uint8_t depth = 0;
+        for (;;) {
+            if (pc >= PATTERN_VM_MAX_LENGTH) {
+                return false;
+            }
+            uint8_t op = fetch(pc++);
+            if (op >= VM_OP_COUNT) {
+                return false;
+            }
+            PatternOpInfo info;
+            memcpy_P(&info, &PATTERN_OP_INFO[op], sizeof(info));
+            if (depth < info.pops) {
+                return false;
+            }
+            depth = depth - info.pops + info.pushes;
+            if (depth > PATTERN_VM_STACK_DEPTH) {
+                return false;
+            }
+            pc += info.operands;
+            if (op == VM_OP_HSV) {
+                // Hue and value must be the only things left
+                if (depth != 0) {
+                    return false;
+                }
+                break;
+            }
+        }
+    }
+    length = pc;
+    return true;
+}
+
+uint32_t PatternVM::evaluate(uint8_t ring, uint16_t index, uint16_t count, uint16_t angle,
+                             const PatternVMContext& context) const {
+    uint16_t stack[PATTERN_VM_STACK_DEPTH];
+    uint8_t sp = 0;
+    uint16_t pc = ringStart[ring];
+
+    for (;;) {
+        uint8_t op = fetch(pc++);
+        switch (op) {
+            case VM_OP_HSV:
+                return fastHsv(stack[0], stack[1]);
+            case VM_OP_PUSH8:
+                stack[sp++] = fetch(pc++);
+                break;
+            case VM_OP_PUSH16:
+                stack[sp++] = fetch(pc) | ((uint16_t)fetch(pc + 1) << 8);
+                pc += 2;
+                break;
+            case VM_OP_PHASE: {
+                uint32_t rate = fetch(pc) | ((uint32_t)fetch(pc + 1) << 8) |
+                                ((uint32_t)fetch(pc + 2) << 16) | ((uint32_t)fetch(pc + 3) << 24);
+                pc += 4;
+                stack[sp++] = (uint16_t)((context.time * rate) >> 16);
+                break;
+            }
+            case VM_OP_INDEX:
+                stack[sp++] = index;
+                break;
+            case VM_OP_MIRROR:
+                stack[sp++] = min(index, (uint16_t)(count - index));
+                break;
+            case VM_OP_ANGLE:
+                stack[sp++] = angle;
+                break;
+            case VM_OP_HUE:
+                stack[sp++] = context.patternHue;
+                break;
+            case VM_OP_ADD:
+                sp--;
+                stack[sp - 1] += stack[sp];
+                break;
+            case VM_OP_SUB:
+                sp--;
+                stack[sp - 1] -= stack[sp];
+                break;
+            case VM_OP_MUL:
+                sp--;
+                stack[sp - 1] *= stack[sp];
+                break;
+            case VM_OP_MULQ:
+                sp--;
+                stack[sp - 1] = ((int32_t)(int16_t)stack[sp - 1] * (int16_t)stack[sp]) >> 15;
+                break;
+            case VM_OP_SIN:
+                stack[sp - 1] = fastSin16(stack[sp - 1]);
+                break;
+            case VM_OP_COS:
+                stack[sp - 1] = fastCos16(stack[sp - 1]);
+                break;
+            case VM_OP_TRI:
+                stack[sp - 1] = fastTri16(stack[sp - 1]);
+                break;
+            case VM_OP_NOISE:
+                stack[sp - 1] = noiseToQ15(fastNoise8(stack[sp - 1]));
+                break;
+            case VM_OP_NOISE2:
+                sp--;
+                stack[sp - 1] = noiseToQ15(fastNoise8(stack[sp - 1], stack[sp]));
+                break;
+            case VM_OP_LEVEL: {
+                sp -= 2;
+                uint8_t low = stack[sp];
+                uint8_t range = (uint8_t)stack[sp + 1] - low;
+                stack[sp - 1] = low + fastScale8((uint16_t)(stack[sp - 1] + 32767u) >> 8, range);
+                break;
+            }
+            case VM_OP_QUIET:
+                sp--;
+                if (context.quietLevel != 0) {
+                    int16_t normal = stack[sp - 1];
+                    stack[sp - 1] = normal + ((((int32_t)(int16_t)stack[sp] - normal) * context.quietLevel) >> 8);
+                }
+                break;
+            case VM_OP_DUP:
+                stack[sp] = stack[sp - 1];
+                sp++;
+                break;
+            case VM_OP_SWAP: {
+                uint16_t top = stack[sp - 1];
+                stack[sp - 1] = stack[sp - 2];
+                stack[sp - 2] = top;
+                break;
+            }
+            case VM_OP_SPREAD: {
+                uint32_t spread = fetch(pc) | ((uint32_t)fetch(pc + 1) << 8) |
+                                  ((uint32_t)fetch(pc + 2) << 16) | ((uint32_t)fetch(pc + 3) << 24);
+                pc += 4;
+                stack[sp - 1] = (uint16_t)((stack[sp - 1] * spread) >> 16);
+                break;
+            }
+            case VM_OP_FOLD:
+                stack[sp - 1] = min(stack[sp - 1], (uint16_t)-stack[sp - 1]);
+                break;
+        }
+    }
+}
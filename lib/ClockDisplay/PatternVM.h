@@ -0,0 +1,120 @@
+#ifndef PATTERN_VM_H
+#define PATTERN_VM_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+
+/**
+ * PatternVM - Bytecode interpreter for per-LED color programs
+ *
+ * A pattern program is a 16-bit hue step (pattern hue advance per
+ * second, little-endian) followed by two ring programs, outer then
+ * inner. Each ring program runs once per LED on a small stack of 16-bit
+ * values and ends with VM_OP_HSV, which takes the hue and value left on
+ * the stack and produces the LED's color.
+ *
+ * Angles, hues and Q15 samples share the FastTrig conventions (65536 =
+ * one turn). Programs can live in PROGMEM or EEPROM and are validated
+ * before each frame - unknown ops, stack overflow/underflow or a
+ * missing VM_OP_HSV reject the program - so evaluation itself does no
+ * checking.
+ *
+ * Budget: 36 LEDs at TARGET_FPS (30). The stock pattern programs
+ * (PATTERN_PROGRAMS) run 10-40 ops per LED.
+ */
+
+enum PatternOp {
+    VM_OP_HSV = 0,       // hue value -> (end of ring program)
+    VM_OP_PUSH8 = 1,     // -> byte operand
+    VM_OP_PUSH16 = 2,    // -> 16-bit operand
+    VM_OP_PHASE = 3,     // -> time * rate, rate a 32-bit Q16.16 operand (angle units per ms)
+    VM_OP_INDEX = 4,     // -> LED index within the ring
+    VM_OP_MIRROR = 5,    // -> distance of the LED from LED 0, in LEDs
+    VM_OP_ANGLE = 6,     // -> angle of the LED around the ring (from the RingGeometry)
+    VM_OP_HUE = 7,       // -> cycling pattern hue
+    VM_OP_ADD = 8,       // a b -> a + b
+    VM_OP_SUB = 9,       // a b -> a - b
+    VM_OP_MUL = 10,      // a b -> a * b (low 16 bits)
+    VM_OP_MULQ = 11,     // a b -> a * b >> 15 (signed, b a Q15 sample or a small scale)
+    VM_OP_SIN = 12,      // angle -> Q15 sine
+    VM_OP_COS = 13,      // angle -> Q15 cosine
+    VM_OP_TRI = 14,      // angle -> Q15 triangle (peaks aligned with sine)
+    VM_OP_NOISE = 15,    // x -> Q15 1D value noise
+    VM_OP_NOISE2 = 16,   // x y -> Q15 2D value noise
+    VM_OP_LEVEL = 17,    // sample min max -> min + (max - min) * (sample + 1) / 2
+    VM_OP_QUIET = 18,    // normal quiet -> blended from normal to quiet by the quiet level
+    VM_OP_DUP = 19,      // a -> a a
+    VM_OP_SWAP = 20,     // a b -> b a
+    VM_OP_SPREAD = 21,   // a -> a * spread >> 16, spread a 32-bit Q16.16 operand
+    VM_OP_FOLD = 22,     // angle -> distance from angle 0 (0 to 32768)
+    VM_OP_COUNT = 23
+};
+
+#define PATTERN_VM_STACK_DEPTH 8
+#define PATTERN_VM_MAX_LENGTH 256
+
+// Assembler helpers for writing programs as byte arrays
+#define VM_HEADER(hueStep) (uint8_t)((uint16_t)(hueStep) & 0xFF), (uint8_t)((uint16_t)(hueStep) >> 8)
+#define VM_PUSH8(value) VM_OP_PUSH8, (uint8_t)(value)
+#define VM_PUSH16(value) VM_OP_PUSH16, (uint8_t)((uint16_t)(value) & 0xFF), (uint8_t)((uint16_t)(value) >> 8)
+#define VM_PHASE(rate) VM_OP_PHASE, (uint8_t)((uint32_t)(rate) & 0xFF), (uint8_t)(((uint32_t)(rate) >> 8) & 0xFF), \
+                       (uint8_t)(((uint32_t)(rate) >> 16) & 0xFF), (uint8_t)((uint32_t)(rate) >> 24)
+#define VM_SPREAD(spread) VM_OP_SPREAD, (uint8_t)((uint32_t)(spread) & 0xFF), (uint8_t)(((uint32_t)(spread) >> 8) & 0xFF), \
+                          (uint8_t)(((uint32_t)(spread) >> 16) & 0xFF), (uint8_t)((uint32_t)(spread) >> 24)
+#define VM_QUIET8(normal, quiet) VM_PUSH8(normal), VM_PUSH8(quiet), VM_OP_QUIET
+
+// Sine wave at the LED's angle: sin(time * rate + offset + angle * spread),
+// spread in angle units across the whole ring (the PatternDescriptor
+// WAVE_SINE sampling, so it fits any ring size)
+#define VM_WAVE(rate, offset, spread) VM_PHASE(rate), VM_PUSH16(offset), VM_OP_ADD, \
+                                      VM_OP_ANGLE, VM_SPREAD(spread), VM_OP_ADD, VM_OP_SIN
+
+// Noise on a circle of the given radius around the ring, drifting with
+// time (the PatternDescriptor WAVE_NOISE sampling)
+#define VM_NOISE(rate, offset, radius) VM_PHASE(rate), VM_PUSH16(offset), VM_OP_ADD, \
+                                       VM_OP_ANGLE, VM_OP_COS, VM_PUSH16(radius), VM_OP_MULQ, VM_OP_ADD, \
+                                       VM_PUSH16(offset), VM_OP_ANGLE, VM_OP_SIN, VM_PUSH16(radius), VM_OP_MULQ, VM_OP_ADD, \
+                                       VM_OP_NOISE2
+
+// Per-frame inputs to a program
+struct PatternVMContext {
+    uint32_t time;
+    uint16_t patternHue;
+    uint16_t quietLevel;   // 0 normal to 256 fully quiet
+};
+
+class PatternVM {
+public:
+    PatternVM();
+
+    // Select and validate a program; returns false if it is malformed
+    bool load(const uint8_t* progmemProgram);
+    bool loadFromEeprom(int address);
+
+    bool isLoaded() const { return loaded; }
+    uint16_t getHueStep() const { return hueStep; }
+    uint16_t getLength() const { return length; }
+
+    // Color of LED index (of count, at angle) using the outer (0) or
+    // inner (1) ring program
+    uint32_t evaluate(uint8_t ring, uint16_t index, uint16_t count, uint16_t angle,
+                      const PatternVMContext& context) const;
+
+private:
+    const uint8_t* program;
+    int eepromAddress;
+    bool fromEeprom;
+    bool loaded;
+    uint16_t hueStep;
+    uint16_t length;
+    uint16_t ringStart[2];
+
+    uint8_t fetch(uint16_t offset) const;
+    bool validate();
+};
+
+// Programs for the built-in patterns, indexed by ClockDisplay::Pattern
+// (pointers in PROGMEM, read with pgm_read_ptr)
+extern const uint8_t* const PATTERN_PROGRAMS[] PROGMEM;
+
+#endif // PATTERN_VM_H
@@ -0,0 +1,93 @@
+#include "RingGeometry.h"
+
+RingGeometry::RingGeometry(uint16_t outerCount, uint16_t innerCount)
+    : table(nullptr)
+    , ledCount(0)
+    , ringCount(0) {
+    addRing(outerCount);
+    addRing(innerCount);
+}
+
+RingGeometry::RingGeometry(const uint16_t* ringSizes, uint8_t count)
+    : table(nullptr)
+    , ledCount(0)
+    , ringCount(0) {
+    for (uint8_t i = 0; i < count; i++) {
+        addRing(ringSizes[i]);
+    }
+}
+
+RingGeometry::RingGeometry(const LedGeometry* table, uint16_t count)
+    : table(nullptr)
+    , ledCount(0)
+    , ringCount(0) {
+    // Ring sizes from the runs of ring ids; the table is in strip order
+    uint16_t runStart = 0;
+    for (uint16_t i = 1; i <= count; i++) {
+        if (i == count || pgm_read_byte(&table[i].ring) != pgm_read_byte(&table[runStart].ring)) {
+            addRing(i - runStart);
+            runStart = i;
+        }
+    }
+    this->table = table;
+}
+
+uint16_t RingGeometry::locate(uint8_t ring, uint16_t angle, uint16_t& next, uint8_t& share) const {
+    uint16_t size = ringSize[ring];
+    if (table == nullptr) {
+        // The inverse of getAngle(); past the last LED the gap runs on to
+        // a full turn (all of it for a one-LED ring, whose step is 0)
+        uint16_t step = ringStep[ring];
+        if (step == 0) {
+            next = 0;
+            share = angle >> 8;
+            return 0;
+        }
+        uint16_t led = min(angle / step, size - 1);
+        uint16_t start = led * step;
+        uint32_t gap = led + 1 < size ? step : 0x10000UL - start;
+        next = led + 1 < size ? led + 1 : 0;
+        share = ((uint32_t)(uint16_t)(angle - start) << 8) / gap;
+        return led;
+    }
+    
+    // Table LEDs may start anywhere and be unevenly spaced, so find the
+    // closest LED on each side of the angle
+    uint16_t led = 0;
+    uint32_t behind = 0x10000;
+    uint32_t ahead = 0x10000;
+    next = 0;
+    for (uint16_t i = 0; i < size; i++) {
+        uint16_t ledAngle = getAngle(ring, i);
+        uint16_t back = angle - ledAngle;
+        uint16_t forward = ledAngle - angle;
+        if (back < behind) {
+            behind = back;
+            led = i;
+        }
+        if (forward != 0 && forward < ahead) {
+            ahead = forward;
+            next = i;
+        }
+    }
+    share = behind == 0 ? 0 : (behind << 8) / (behind + ahead);
+    return led;
+}
+
+uint16_t RingGeometry::nearestLed(uint8_t ring, uint16_t angle) const {
+    uint16_t next;
+    uint8_t share;
+    uint16_t led = locate(ring, angle, next, share);
+    return share < 128 ? led : next;
+}
+
+void RingGeometry::addRing(uint16_t size) {
+    if (ringCount >= CLOCK_MAX_RINGS || size == 0) {
+        return;
+    }
+    ringFirst[ringCount] = ledCount;
+    ringSize[ringCount] = size;
+    ringStep[ringCount] = 65536UL / size;
+    ledCount += size;
+    ringCount++;
+}
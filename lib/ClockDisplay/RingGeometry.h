@@ -0,0 +1,72 @@
+#ifndef RING_GEOMETRY_H
+#define RING_GEOMETRY_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include <ClockConfig.h>
+
+/**
+ * RingGeometry - Where each LED of the strip sits on the clock face
+ * 
+ * The strip is a series of rings (up to CLOCK_MAX_RINGS), each a
+ * contiguous run of LEDs, outermost first. Every LED has a ring id and
+ * a 16-bit angle (65536 = one turn, 0 = 12 o'clock) that patterns
+ * sample from.
+ * 
+ * Evenly spaced rings only need their sizes; the angles are computed.
+ * Anything else - rings whose LED 0 is not at 12 o'clock, uneven
+ * spacing, partial arcs - is described by a per-LED LedGeometry table
+ * in PROGMEM, in strip order:
+ * 
+ *   const LedGeometry FACE[] PROGMEM = { { 0, 0 }, { 0, 2731 }, ... };
+ *   RingGeometry geometry(FACE, sizeof(FACE) / sizeof(FACE[0]));
+ */
+
+struct LedGeometry {
+    uint8_t ring;
+    uint16_t angle;
+};
+
+class RingGeometry {
+public:
+    // Two evenly spaced rings (the classic hour and minute rings)
+    RingGeometry(uint16_t outerCount, uint16_t innerCount);
+    
+    // Evenly spaced rings of the given sizes, in strip order
+    RingGeometry(const uint16_t* ringSizes, uint8_t ringCount);
+    
+    // Per-LED table in PROGMEM
+    RingGeometry(const LedGeometry* table, uint16_t ledCount);
+    
+    uint16_t getLedCount() const { return ledCount; }
+    uint8_t getRingCount() const { return ringCount; }
+    uint16_t getRingFirst(uint8_t ring) const { return ringFirst[ring]; }
+    uint16_t getRingSize(uint8_t ring) const { return ringSize[ring]; }
+    
+    // Angle of LED index within a ring
+    uint16_t getAngle(uint8_t ring, uint16_t index) const {
+        if (table != nullptr) {
+            return pgm_read_word(&table[ringFirst[ring] + index].angle);
+        }
+        return index * ringStep[ring];
+    }
+    
+    // LED of a ring at or just behind an angle (clockwise), the LED just
+    // ahead of it and the share (0-255) of the way from one to the other
+    uint16_t locate(uint8_t ring, uint16_t angle, uint16_t& next, uint8_t& share) const;
+    
+    // LED of a ring nearest an angle
+    uint16_t nearestLed(uint8_t ring, uint16_t angle) const;
+    
+private:
+    const LedGeometry* table;
+    uint16_t ledCount;
+    uint8_t ringCount;
+    uint16_t ringFirst[CLOCK_MAX_RINGS];
+    uint16_t ringSize[CLOCK_MAX_RINGS];
+    uint16_t ringStep[CLOCK_MAX_RINGS];   // Angle between LEDs of evenly spaced rings
+    
+    void addRing(uint16_t size);
+};
+
+#endif // RING_GEOMETRY_H
@@ -0,0 +1,120 @@
+#include "Timeline.h"
+#include <Adafruit_NeoPixel.h>
+
+// No keyframe on that side of the current time
+#define TIMELINE_NONE 0xFF
+
+Timeline::Timeline()
+    : sequence(nullptr)
+    , keyframes(nullptr)
+    , count(0)
+    , duration(0) {
+}
+
+void Timeline::start(const TimelineSequence* sequence, ClockCompositor& layers) {
+    TimelineSequence s;
+    memcpy_P(&s, sequence, sizeof(s));
+    this->sequence = sequence;
+    keyframes = s.keyframes;
+    count = s.count;
+    duration = s.duration;
+    
+    layers.clear(ClockCompositor::LAYER_EFFECTS);
+    layers.setBlendMode(ClockCompositor::LAYER_EFFECTS, (ClockCompositor::BlendMode)s.blendMode, s.opacity);
+    layers.setEnabled(ClockCompositor::LAYER_EFFECTS, true);
+}
+
+uint16_t Timeline::ease(uint8_t easing, uint16_t fraction) {
+    switch (easing) {
+        case EASE_STEP:
+            return 0;
+        case EASE_IN:
+            return ((uint32_t)fraction * fraction) >> 8;
+        case EASE_OUT: {
+            uint16_t rest = 256 - fraction;
+            return 256 - (((uint32_t)rest * rest) >> 8);
+        }
+        case EASE_IN_OUT:
+            // f^2 (3 - 2f) with f in 8.8
+            return ((uint32_t)fraction * fraction * (768 - 2 * fraction)) >> 16;
+        default:
+            return fraction;
+    }
+}
+
+static inline uint8_t lerp8(uint8_t from, uint8_t to, uint16_t fraction) {
+    return from + (((int16_t)(to - from) * (int32_t)fraction) >> 8);
+}
+
+bool Timeline::render(ClockCompositor& layers, const RingGeometry& geometry,
+                      uint16_t patternHue, uint32_t elapsed) {
+    if (sequence == nullptr) {
+        return false;
+    }
+    if (elapsed >= duration) {
+        sequence = nullptr;
+        return false;
+    }
+    
+    // Last keyframe at or before now, and first after it, of each track;
+    // slot CLOCK_MAX_RINGS is TIMELINE_ALL_RINGS
+    uint8_t before[CLOCK_MAX_RINGS + 1];
+    uint8_t after[CLOCK_MAX_RINGS + 1];
+    memset(before, TIMELINE_NONE, sizeof(before));
+    memset(after, TIMELINE_NONE, sizeof(after));
+    for (uint8_t k = 0; k < count; k++) {
+        uint8_t track = pgm_read_byte(&keyframes[k].track);
+        uint8_t slot = track == TIMELINE_ALL_RINGS ? CLOCK_MAX_RINGS : track;
+        if (slot > CLOCK_MAX_RINGS || pgm_read_byte(&keyframes[k].layer) >= ClockCompositor::LAYER_COUNT) {
+            continue;
+        }
+        if (pgm_read_word(&keyframes[k].time) <= elapsed) {
+            before[slot] = k;
+        } else if (after[slot] == TIMELINE_NONE) {
+            after[slot] = k;
+        }
+    }
+    
+    // Every LED first, so ring tracks draw over it
+    for (uint8_t i = 0; i <= CLOCK_MAX_RINGS; i++) {
+        uint8_t slot = i == 0 ? CLOCK_MAX_RINGS : i - 1;
+        if (before[slot] == TIMELINE_NONE) {
+            continue;
+        }
+        
+        int first = 0;
+        int leds = geometry.getLedCount();
+        if (slot < CLOCK_MAX_RINGS) {
+            if (slot >= geometry.getRingCount()) {
+                continue;
+            }
+            first = geometry.getRingFirst(slot);
+            leds = geometry.getRingSize(slot);
+        }
+        
+        TimelineKeyframe from;
+        memcpy_P(&from, &keyframes[before[slot]], sizeof(from));
+        uint8_t r = from.r;
+        uint8_t g = from.g;
+        uint8_t b = from.b;
+        if (after[slot] != TIMELINE_NONE) {
+            TimelineKeyframe to;
+            memcpy_P(&to, &keyframes[after[slot]], sizeof(to));
+            uint16_t fraction = ((uint32_t)(elapsed - from.time) << 8) / (to.time - from.time);
+            fraction = ease(to.easing & TIMELINE_EASING_MASK, fraction);
+            r = lerp8(from.r, to.r, fraction);
+            g = lerp8(from.g, to.g, fraction);
+            b = lerp8(from.b, to.b, fraction);
+        }
+        
+        uint32_t color;
+        if (from.easing & TIMELINE_PATTERN_HUE) {
+            color = Adafruit_NeoPixel::ColorHSV(patternHue + ((uint16_t)r << 8), g, b);
+        } else {
+            color = Adafruit_NeoPixel::Color(r, g, b);
+        }
+        layers.fill((ClockCompositor::Layer)from.layer, color, first, leds);
+    }
+    
+    return true;
+}
@@ -0,0 +1,92 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "ClockCompositor.h"
+#include "RingGeometry.h"
+
+/**
+ * Timeline - Keyframed light sequences played from PROGMEM
+ * 
+ * A sequence is a list of keyframes in time order. Each keyframe sets
+ * the color of one track - a ring, or every LED - on a compositor
+ * layer at a time from the start of the sequence. Between two
+ * keyframes of a track the color is interpolated in 8.8 fixed point
+ * with the later keyframe's easing; after a track's last keyframe its
+ * color holds, and before its first the track draws nothing.
+ * 
+ * Colors are RGB, or with TIMELINE_PATTERN_HUE a hue offset from the
+ * cycling pattern hue (r, 256 = one turn), saturation (g) and value (b),
+ * so a sequence can follow whatever pattern is showing.
+ * 
+ * Nothing blocks: render() draws the frame for the elapsed time, so
+ * playback speed doesn't depend on the frame rate. A keyframe is 8
+ * bytes of flash; the sequence header 7 more.
+ */
+
+enum TimelineEasing {
+    EASE_STEP = 0,       // Hold the previous color, then jump
+    EASE_LINEAR = 1,
+    EASE_IN = 2,         // Quadratic, slow start
+    EASE_OUT = 3,        // Quadratic, slow finish
+    EASE_IN_OUT = 4      // Smoothstep
+};
+
+// Keyframe flags, or'd into the easing byte
+#define TIMELINE_EASING_MASK 0x0F
+#define TIMELINE_PATTERN_HUE 0x80
+
+// Tracks: a ring index, or every LED
+#define TIMELINE_ALL_RINGS 0xFF
+
+struct TimelineKeyframe {
+    uint16_t time;       // ms from the start of the sequence
+    uint8_t track;       // Ring index or TIMELINE_ALL_RINGS
+    uint8_t layer;       // ClockCompositor::Layer (keyframes on other layers are skipped)
+    uint8_t easing;      // TimelineEasing into this keyframe, plus flags
+    uint8_t r, g, b;     // Color (hue offset, saturation, value with TIMELINE_PATTERN_HUE)
+};
+
+struct TimelineSequence {
+    const TimelineKeyframe* keyframes;   // PROGMEM
+    uint8_t count;
+    uint16_t duration;   // ms; the sequence ends here
+    uint8_t blendMode;   // ClockCompositor::BlendMode of the effects layer
+    uint8_t opacity;
+};
+
+// Sequence header for a PROGMEM keyframe array
+#define TIMELINE_SEQUENCE(keys, duration, blendMode, opacity) \
+    { keys, sizeof(keys) / sizeof(keys[0]), duration, blendMode, opacity }
+
+class Timeline {
+public:
+    Timeline();
+    
+    // Begin a PROGMEM sequence; the effects layer is cleared and set to
+    // the sequence's blend mode
+    void start(const TimelineSequence* sequence, ClockCompositor& layers);
+    void stop() { sequence = nullptr; }
+    bool isPlaying() const { return sequence != nullptr; }
+    
+    // Draw the frame elapsed ms into the sequence; returns false (drawing
+    // nothing) once the sequence has ended
+    bool render(ClockCompositor& layers, const RingGeometry& geometry,
+                uint16_t patternHue, uint32_t elapsed);
+    
+    // Eased fraction (0-256) of the way between two keyframes
+    static uint16_t ease(uint8_t easing, uint16_t fraction);
+    
+private:
+    const TimelineSequence* sequence;
+    const TimelineKeyframe* keyframes;
+    uint8_t count;
+    uint16_t duration;
+};
+
+// Built-in quarter-hour sequences (Timelines.cpp): one bloom at :15, two
+// at :30 and three at :45, indexed by quarter - 1
+extern const TimelineSequence* const QUARTER_HOUR_TIMELINES[3] PROGMEM;
+
+#endif // TIMELINE_H
@@ -0,0 +1,48 @@
+#include "Timeline.h"
+
+// Quarter-hour blooms: the pattern hue at saturation 180 swelling up to
+// value 200 and back, added over the pattern. The :15, :30 and :45
+// sequences bloom once, twice and three times; the last steps the hue a
+// third of a turn each time.
+
+#define BLOOM(time, easing, hue, value) \
+    { time, TIMELINE_ALL_RINGS, ClockCompositor::LAYER_EFFECTS, (easing) | TIMELINE_PATTERN_HUE, hue, 180, value }
+
+static const TimelineKeyframe QUARTER_PAST_KEYS[] PROGMEM = {
+    BLOOM(0, EASE_STEP, 0, 0),
+    BLOOM(1200, EASE_OUT, 0, 200),
+    BLOOM(3000, EASE_IN_OUT, 0, 0)
+};
+
+static const TimelineKeyframe HALF_PAST_KEYS[] PROGMEM = {
+    BLOOM(0, EASE_STEP, 0, 0),
+    BLOOM(800, EASE_OUT, 0, 200),
+    BLOOM(1800, EASE_IN_OUT, 0, 0),
+    BLOOM(2600, EASE_OUT, 0, 200),
+    BLOOM(3600, EASE_IN_OUT, 0, 0)
+};
+
+static const TimelineKeyframe QUARTER_TO_KEYS[] PROGMEM = {
+    BLOOM(0, EASE_STEP, 0, 0),
+    BLOOM(600, EASE_OUT, 0, 200),
+    BLOOM(1400, EASE_IN_OUT, 0, 0),
+    BLOOM(1400, EASE_STEP, 85, 0),
+    BLOOM(2000, EASE_OUT, 85, 200),
+    BLOOM(2800, EASE_IN_OUT, 85, 0),
+    BLOOM(2800, EASE_STEP, 170, 0),
+    BLOOM(3400, EASE_OUT, 170, 200),
+    BLOOM(4200, EASE_IN_OUT, 170, 0)
+};
+
+static const TimelineSequence QUARTER_PAST PROGMEM =
+    TIMELINE_SEQUENCE(QUARTER_PAST_KEYS, 3000, ClockCompositor::BLEND_ADD, 255);
+static const TimelineSequence HALF_PAST PROGMEM =
+    TIMELINE_SEQUENCE(HALF_PAST_KEYS, 3600, ClockCompositor::BLEND_ADD, 255);
+static const TimelineSequence QUARTER_TO PROGMEM =
+    TIMELINE_SEQUENCE(QUARTER_TO_KEYS, 4200, ClockCompositor::BLEND_ADD, 255);
+
+const TimelineSequence* const QUARTER_HOUR_TIMELINES[3] PROGMEM = {
+    &QUARTER_PAST,
+    &HALF_PAST,
+    &QUARTER_TO
+};
@@ -0,0 +1,85 @@
+/**
+ * RingBenchmark - Frame time of ClockDisplay at 36, 96 and 240 LEDs
+ * 
+ * Renders each layout for a few patterns and prints the average time
+ * per frame for the pattern (render) and for compose + strip output
+ * (show), then the show time again with a per-LED color correction
+ * table, which is the only output stage cost that grows per pixel.
+ * The show time includes pushing the frame to the strip; build with
+ * -DCLOCK_OUTPUT_NULL to time the output stage alone, or with
+ * -DCLOCK_OUTPUT_APA102 to compare an SPI strip.
+ * Only one display exists at a time, but 240 LEDs still need
+ * about 3 KB of buffers, so run it on an ATmega2560-class board; an
+ * ATmega328 manages the 36 and 96 LED layouts.
+ */
+#include <ClockDisplay.h>
+
+#define BENCHMARK_PIN 6
+#define BENCHMARK_FRAMES 50
+
+static const uint16_t LAYOUT_36[] = { 24, 12 };
+static const uint16_t LAYOUT_96[] = { 60, 24, 12 };
+static const uint16_t LAYOUT_240[] = { 120, 60, 36, 24 };
+
+static const ClockDisplay::Pattern BENCHMARK_PATTERNS[] = {
+    ClockDisplay::DEFAULT_COMPLEMENT,
+    ClockDisplay::SLOW_SPIRAL,
+    ClockDisplay::COLOR_DRIFT,
+    ClockDisplay::LIQUID_NOISE
+};
+
+void benchmarkLayout(const uint16_t* sizes, uint8_t rings) {
+    ClockDisplay* display = new ClockDisplay(BENCHMARK_PIN, RingGeometry(sizes, rings));
+    display->begin();
+    
+    for (uint8_t p = 0; p < sizeof(BENCHMARK_PATTERNS) / sizeof(BENCHMARK_PATTERNS[0]); p++) {
+        uint32_t renderMicros = 0;
+        uint32_t showMicros = 0;
+        for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+            uint32_t start = micros();
+            display->displayPattern(BENCHMARK_PATTERNS[p]);
+            display->showHourIndicators(frame % 12 + 1);
+            uint32_t rendered = micros();
+            display->invalidate();
+            display->show();
+            renderMicros += rendered - start;
+            showMicros += micros() - rendered;
+        }
+        
+        Serial.print(display->getGeometry().getLedCount());
+        Serial.print(" LEDs, pattern ");
+        Serial.print(BENCHMARK_PATTERNS[p]);
+        Serial.print(": render ");
+        Serial.print(renderMicros / BENCHMARK_FRAMES);
+        Serial.print(" us, show ");
+        Serial.print(showMicros / BENCHMARK_FRAMES);
+        Serial.println(" us");
+    }
+    
+    uint16_t ledCount = display->getGeometry().getLedCount();
+    for (uint16_t i = 0; i < ledCount; i++) {
+        display->setLedCorrection(i, 250, 240, 230);
+    }
+    uint32_t start = micros();
+    for (int frame = 0; frame < BENCHMARK_FRAMES; frame++) {
+        display->invalidate();
+        display->show();
+    }
+    Serial.print(ledCount);
+    Serial.print(" LEDs, show with LED color correction ");
+    Serial.print((micros() - start) / BENCHMARK_FRAMES);
+    Serial.println(" us");
+    
+    delete display;
+}
+
+void setup() {
+    Serial.begin(115200);
+    Serial.println("RingBenchmark: frame time per layout");
+    benchmarkLayout(LAYOUT_36, 2);
+    benchmarkLayout(LAYOUT_96, 3);
+    benchmarkLayout(LAYOUT_240, 4);
+}
+
+void loop() {
+}
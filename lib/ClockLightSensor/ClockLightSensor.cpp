@@ -0,0 +1,104 @@
+#include "ClockLightSensor.h"
+
+// Shared with the ADC interrupt. There is only one ADC, so this state
+// is per program rather than per sensor.
+static volatile uint16_t blockSum;
+static volatile uint8_t blockCount;
+static volatile uint16_t readySum;
+static volatile bool blockReady;
+static volatile uint16_t lastSample;
+
+ISR(ADC_vect) {
+    uint16_t sample = ADC;
+    lastSample = sample;
+    uint16_t sum = blockSum + sample;
+    if (++blockCount == AMBIENT_BLOCK_SAMPLES) {
+        // update() takes the block whenever it next runs; if it falls
+        // behind, the newer block simply replaces the older one
+        readySum = sum;
+        blockReady = true;
+        sum = 0;
+        blockCount = 0;
+    }
+    blockSum = sum;
+}
+
+ClockLightSensor::ClockLightSensor()
+    : running(false)
+    , filtered(0)
+    , level(0) {
+}
+
+void ClockLightSensor::begin(uint8_t pin) {
+    uint8_t channel = (pin >= A0 ? pin - A0 : pin) & 0x07;
+    
+    // One blocking conversion (setup only) so the level is right from the start
+    uint16_t first = analogRead(pin);
+    filtered = first << AMBIENT_BLOCK_SHIFT;
+    level = first;
+    
+    noInterrupts();
+    blockSum = 0;
+    blockCount = 0;
+    blockReady = false;
+    lastSample = first;
+    
+    // AVcc reference, right adjusted
+    ADMUX = _BV(REFS0) | channel;
+    
+    // The pin is analog only - drop its digital input buffer (A6/A7 have none)
+    if (channel < 6) {
+        DIDR0 |= _BV(channel);
+    }
+    
+    // Trigger on Timer0 overflow, prescaler 128 (125 kHz ADC clock)
+    ADCSRB = (ADCSRB & ~(_BV(ADTS2) | _BV(ADTS1) | _BV(ADTS0))) | _BV(ADTS2);
+    ADCSRA = _BV(ADEN) | _BV(ADATE) | _BV(ADIE) | _BV(ADIF) |
+             _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+    interrupts();
+    
+    running = true;
+    Serial.print("ClockLightSensor: Sampling pin A");
+    Serial.print(channel);
+    Serial.print(", level ");
+    Serial.println(level);
+}
+
+void ClockLightSensor::end() {
+    if (!running) {
+        return;
+    }
+    // Back to the single-conversion setup analogRead() expects
+    ADCSRA = _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0);
+    running = false;
+}
+
+uint16_t ClockLightSensor::getLastSample() const {
+    noInterrupts();
+    uint16_t sample = lastSample;
+    interrupts();
+    return sample;
+}
+
+bool ClockLightSensor::update() {
+    if (!running || !blockReady) {
+        return false;
+    }
+    
+    noInterrupts();
+    uint16_t sum = readySum;
+    blockReady = false;
+    interrupts();
+    
+    // EMA in block-sum units; the arithmetic shift rounds toward minus
+    // infinity, which biases the result by under one ADC count
+    filtered += ((int32_t)sum - filtered) >> AMBIENT_FILTER_SHIFT;
+    
+    uint16_t newLevel = filtered >> AMBIENT_BLOCK_SHIFT;
+    uint16_t change = newLevel > level ? newLevel - level : level - newLevel;
+    if (change < AMBIENT_HYSTERESIS) {
+        return false;
+    }
+    level = newLevel;
+    return true;
+}
@@ -0,0 +1,61 @@
+#ifndef CLOCK_LIGHT_SENSOR_H
+#define CLOCK_LIGHT_SENSOR_H
+
+#include <Arduino.h>
+#include <ClockConfig.h>
+
+/**
+ * ClockLightSensor - Ambient light level from a photoresistor
+ * 
+ * Wire the photoresistor from 5V to an analog pin with a pull-down
+ * (10k) to ground, so brighter rooms read higher.
+ * 
+ * After begin() the ADC samples the pin in the background: conversions
+ * are triggered by the Timer0 overflow that already drives millis()
+ * (about 1 kHz) and collected by the ADC interrupt, so nothing in
+ * loop() ever waits on a conversion. update() takes each finished
+ * block of AMBIENT_BLOCK_SAMPLES readings, runs it through an integer
+ * EMA (AMBIENT_FILTER_SHIFT) and only reports a new level once it has
+ * moved by AMBIENT_HYSTERESIS or more, so a flickering room doesn't
+ * keep changing the brightness.
+ * 
+ * The sensor owns the ADC while running - there is one ADC, so only
+ * one sensor can be active, and analogRead() must not be used until
+ * end() is called.
+ */
+// Readings are summed in blocks of 64 (at most 64 * 1023, so a block
+// sum fits 16 bits) - one filter step every 65 ms
+#define AMBIENT_BLOCK_SHIFT 6
+#define AMBIENT_BLOCK_SAMPLES (1 << AMBIENT_BLOCK_SHIFT)
+
+class ClockLightSensor {
+public:
+    ClockLightSensor();
+    
+    // Start background sampling of an analog pin (A0-A7)
+    void begin(uint8_t pin = AMBIENT_LIGHT_PIN);
+    
+    // Stop sampling and hand the ADC back to analogRead()
+    void end();
+    
+    // Filter any new samples - returns true if the level changed
+    bool update();
+    
+    // Level (0-1023) last reported by update(), after hysteresis
+    uint16_t getLevel() const { return level; }
+    
+    // Filtered level before hysteresis
+    uint16_t getFilteredLevel() const { return filtered >> AMBIENT_BLOCK_SHIFT; }
+    
+    // Most recent raw reading - its low bits are noisy enough to seed random()
+    uint16_t getLastSample() const;
+    
+    bool isRunning() const { return running; }
+    
+private:
+    bool running;
+    uint16_t filtered;   // Sum of a block's samples, so AMBIENT_BLOCK_SHIFT fraction bits
+    uint16_t level;
+};
+
+#endif // CLOCK_LIGHT_SENSOR_H
@@ -3,7 +3,8 @@
 ClockTime::ClockTime() 
     : currentHour(-1), currentMinute(-1), currentSecond(-1)
     , lastHour(-1), lastMinute(-1), lastSecond(-1)
-    , secondChanged(false), minuteChanged(false), hourChanged(false) {
+    , secondChanged(false), minuteChanged(false), hourChanged(false)
+    , lastPollTime(0), secondStartTime(0), rolloverWindow(0), phaseValid(false) {
 }
 
 void ClockTime::begin() {
@@ -12,24 +13,43 @@ void ClockTime::begin() {
 }
 
 bool ClockTime::update() {
+    uint32_t now = millis();
+    
+    // Minutes and hours only change with the second, so most polls are a
+    // single register read
+    int newSecond = rtc.getSecond();
+    secondChanged = (newSecond != currentSecond);
+    minuteChanged = false;
+    hourChanged = false;
+    if (!secondChanged) {
+        lastPollTime = now;
+        return false;
+    }
+    
     // Read current time
     bool h12Flag = false;
     bool pm = false;
     
-    int newSecond = rtc.getSecond();
     int newMinute = rtc.getMinute();
     int newHour = rtc.getHour(h12Flag, pm);
     
     // Check for changes
-    secondChanged = (newSecond != lastSecond);
-    minuteChanged = (newMinute != lastMinute);
-    hourChanged = (newHour != lastHour);
+    minuteChanged = (newMinute != currentMinute);
+    hourChanged = (newHour != currentHour);
     
-    // Update tracking
-    if (secondChanged) {
-        lastSecond = currentSecond;
-        currentSecond = newSecond;
+    // The second rolled over since the last poll (the first reading
+    // lands mid-second, so it can't anchor the phase)
+    if (currentSecond >= 0) {
+        uint32_t window = now - lastPollTime;
+        rolloverWindow = min(window, (uint32_t)0xFFFF);
+        secondStartTime = lastPollTime + window / 2;
+        phaseValid = true;
     }
+    lastPollTime = now;
+    
+    // Update tracking
+    lastSecond = currentSecond;
+    currentSecond = newSecond;
     
     if (minuteChanged) {
         lastMinute = currentMinute;
@@ -43,3 +63,18 @@ bool ClockTime::update() {
     
     return secondChanged;
 }
+
+uint16_t ClockTime::getMillisIntoSecond() const {
+    if (!phaseValid) {
+        return 0;
+    }
+    // Hold at the end of the second until the RTC shows the next one
+    uint32_t elapsed = millis() - secondStartTime;
+    return elapsed < 1000 ? elapsed : 999;
+}
+
+uint16_t ClockTime::getSecondsAngle() const {
+    // 60000 ms per turn
+    uint32_t ms = (uint32_t)max(currentSecond, 0) * 1000 + getMillisIntoSecond();
+    return (ms * 65536UL) / 60000;
+}
@@ -9,6 +9,13 @@
  * 
  * Provides simplified interface for reading time from DS3231 RTC
  * and tracking time changes (second, minute, hour).
+ * 
+ * The RTC only reports whole seconds, so the sub-second phase is
+ * tracked from millis(): each observed second rollover is anchored
+ * halfway between the poll that saw it and the poll before, so the
+ * phase is as accurate as the polls around the rollover are close
+ * (see getMillisUntilSecond()). Until a second arrives the phase holds
+ * at 999 ms rather than wrapping.
  */
 class ClockTime {
 public:
@@ -26,6 +33,21 @@ public:
     int getSecond() const { return currentSecond; }
     int getHour12() const { return (currentHour % 12) + 1; }
     
+    // Sub-second phase, valid once a second rollover has been observed
+    bool hasSecondPhase() const { return phaseValid; }
+    uint16_t getMillisIntoSecond() const;
+    
+    // Time until the next rollover is expected - poll the RTC around it
+    // to keep the phase tight (1000 until the phase is known)
+    uint16_t getMillisUntilSecond() const { return phaseValid ? 1000 - getMillisIntoSecond() : 1000; }
+    
+    // Position of a sweeping seconds hand, 65536 = one turn
+    uint16_t getSecondsAngle() const;
+    
+    // Width (ms) of the window the last rollover was seen in; the phase
+    // is within half of it
+    uint16_t getRolloverWindow() const { return rolloverWindow; }
+    
     // Check for changes since last update
     bool hasSecondChanged() const { return secondChanged; }
     bool hasMinuteChanged() const { return minuteChanged; }
@@ -50,6 +72,12 @@ private:
     bool secondChanged;
     bool minuteChanged;
     bool hourChanged;
+    
+    // Sub-second phase
+    uint32_t lastPollTime;
+    uint32_t secondStartTime;   // millis() at the last rollover (estimated)
+    uint16_t rolloverWindow;
+    bool phaseValid;
 };
 
 #endif // CLOCK_TIME_H
@@ -30,9 +30,13 @@
 #define MINUTE_LEDS 12
 #define TOTAL_LEDS (HOUR_LEDS + MINUTE_LEDS)
 #define DEFAULT_BRIGHTNESS 63
+// #define POWER_BUDGET_MA 400       // LED current limit in mA, scaled down to fit (USB: 500 mA less the board)
+// #define ENABLE_GAMMA_CORRECTION      // Gamma-correct LED output (patterns are tuned for linear output)
+// #define ENABLE_OUTER_RING_DITHERING  // Temporal dithering for the dim outer ring (use TARGET_FPS 60)
 
 // Timing Configuration
 #define RTC_CHECK_DELAY 50
+#define TARGET_FPS 30                // LED frame rate, independent of the 1 Hz RTC tick
 #define RESTART_WAIT 3000L
 #define RESET_COUNT 5
 #define CALIBRATION_DISPLAY_TIME 3000
@@ -58,6 +62,12 @@
 #define QUIET_HOURS_START 22         // 10:00 PM (22:00) - start of quiet hours
 #define QUIET_HOURS_END 6            // 6:00 AM (06:00) - end of quiet hours
 #define QUIET_BRIGHTNESS_PERCENT 50  // 50% brightness during quiet hours
+#define QUIET_RAMP_MINUTES 30        // Fade into and out of quiet hours (dimmer, warmer) over 30 minutes
+
+// Auto Brightness Configuration
+// #define ENABLE_AUTO_BRIGHTNESS       // Follow room light (photoresistor from 5V to the pin, 10k to GND)
+#define AMBIENT_LIGHT_PIN A6
+#define AMBIENT_MIN_BRIGHTNESS 8     // Brightness in the dark, rising to DEFAULT_BRIGHTNESS in daylight
 
 // Display Pattern Configuration
 #define ENABLE_PATTERN_SYSTEM        // Master enable for advanced patterns
@@ -68,11 +78,13 @@
 // #define TEST_GENTLE_WAVES           // Test gentle waves pattern immediately
 // #define TEST_COLOR_DRIFT            // Test color drift pattern immediately
 // #define ENABLE_QUARTER_HOUR_EFFECTS // Enable 15/30/45 minute celebrations
+// #define ENABLE_SECONDS_SWEEP       // Seconds dot sweeping smoothly around the minute ring
 // #define ENABLE_PATTERN_ROTATION     // Cycle through patterns every few minutes
 
 // Pattern Timing
 #define PATTERN_CHANGE_INTERVAL 180  // Seconds between pattern changes (3 minutes)
-#define QUARTER_HOUR_EFFECT_DURATION 5  // Seconds for quarter-hour animations
+#define PATTERN_TRANSITION_TIME 3000 // Milliseconds to cross-fade between patterns (0 = hard cut)
+// #define PARTICLE_MODE ClockDisplay::PARTICLES_TWINKLE  // Particles over the pattern (or PARTICLES_DROPLETS)
 
 // Sensor States
 #define FOUND LOW
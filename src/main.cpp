@@ -6,7 +6,13 @@
 
 // Hardware instances
 DS3231 rtc;
-Clock hybridClock;
+#ifdef CLOCK_STATIC_DISPLAY
+    // Display buffers sized at compile time, from the LED counts in config.h
+    StaticClockDisplay<HOUR_LEDS, MINUTE_LEDS> display(NEOPIXEL_PIN, DEFAULT_BRIGHTNESS);
+    Clock hybridClock(display);
+#else
+    Clock hybridClock;
+#endif
 
 void setup() {
     Serial.begin(115200);
@@ -23,23 +29,55 @@ void setup() {
     #endif
     
     #ifdef ENABLE_QUIET_HOURS
-        hybridClock.enableQuietHours(true, QUIET_HOURS_START, QUIET_HOURS_END, QUIET_BRIGHTNESS_PERCENT);
+        hybridClock.enableQuietHours(true, QUIET_HOURS_START, QUIET_HOURS_END, QUIET_BRIGHTNESS_PERCENT,
+                                     QUIET_RAMP_MINUTES);
+    #endif
+    
+    #ifdef ENABLE_AUTO_BRIGHTNESS
+        hybridClock.enableAutoBrightness(true, AMBIENT_LIGHT_PIN, AMBIENT_MIN_BRIGHTNESS);
     #endif
     
     #ifdef TEST_HOUR_CHANGE_ON_STARTUP
         hybridClock.enableHourChangeAnimation(true);
     #endif
     
+    hybridClock.setTargetFps(TARGET_FPS);
+    
+    #ifdef ENABLE_GAMMA_CORRECTION
+        hybridClock.getDisplay().setGammaCorrection(true);
+    #endif
+    
+    #ifdef ENABLE_OUTER_RING_DITHERING
+        hybridClock.getDisplay().setDithering(ClockDisplay::OUTER_RING, true);
+    #endif
+    
+    #ifdef POWER_BUDGET_MA
+        hybridClock.getDisplay().setPowerBudget(POWER_BUDGET_MA);
+    #endif
+    
+    #ifdef PARTICLE_MODE
+        hybridClock.getDisplay().setParticleMode(PARTICLE_MODE);
+    #endif
+    
     // Enable micro-calibration every 4 hours
     hybridClock.enableMicroCalibration(true, 4);
     
     #ifdef ENABLE_PATTERN_SYSTEM
         #ifdef ENABLE_HOURLY_PATTERN_ROTATION
             hybridClock.enableHourlyPatternRotation(true);
+            hybridClock.setPatternTransitionTime(PATTERN_TRANSITION_TIME);
         #else
             // Default to breathing rings pattern
             hybridClock.setDisplayPattern(ClockDisplay::BREATHING_RINGS);
         #endif
+        
+        #ifdef ENABLE_QUARTER_HOUR_EFFECTS
+            hybridClock.enableQuarterHourEffects(true);
+        #endif
+        
+        #ifdef ENABLE_SECONDS_SWEEP
+            hybridClock.enableSecondsSweep(true);
+        #endif
     #endif
     
     // Initialize clock with external RTC
@@ -0,0 +1,64 @@
+#ifndef HOST_ADAFRUIT_NEOPIXEL_H
+#define HOST_ADAFRUIT_NEOPIXEL_H
+
+// The parts of Adafruit_NeoPixel the clock uses, with the same protected
+// buffer fields. show() sends nothing.
+
+#include <Arduino.h>
+
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+    Adafruit_NeoPixel(uint16_t n, int16_t p, uint16_t t)
+        : numLEDs(n)
+        , numBytes(n * 3)
+        , pin(p)
+        , pixels((uint8_t*)calloc(n, 3)) {
+    }
+    ~Adafruit_NeoPixel() { free(pixels); }
+    
+    void begin() {}
+    void show() {}
+    void clear() { memset(pixels, 0, numBytes); }
+    void setBrightness(uint8_t) {}
+    uint8_t* getPixels() const { return pixels; }
+    uint16_t numPixels() const { return numLEDs; }
+    
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+    static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255) {
+        // Hue to a 0-1529 position on the color wheel, as the library does
+        uint8_t r, g, b;
+        hue = (hue * 1530L + 32768) / 65536;
+        if (hue < 510) {
+            b = 0;
+            if (hue < 255) { r = 255; g = hue; } else { r = 510 - hue; g = 255; }
+        } else if (hue < 1020) {
+            r = 0;
+            if (hue < 765) { g = 255; b = hue - 510; } else { g = 1020 - hue; b = 255; }
+        } else if (hue < 1530) {
+            g = 0;
+            if (hue < 1275) { r = hue - 1020; b = 255; } else { r = 255; b = 1530 - hue; }
+        } else {
+            r = 255; g = b = 0;
+        }
+        uint32_t v1 = 1 + val;
+        uint16_t s1 = 1 + sat;
+        uint8_t s2 = 255 - sat;
+        return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) |
+               (((((g * s1) >> 8) + s2) * v1) & 0xff00) |
+               (((((b * s1) >> 8) + s2) * v1) >> 8);
+    }
+    static uint8_t gamma8(uint8_t x) { return x; }
+    
+protected:
+    uint16_t numLEDs;
+    uint16_t numBytes;
+    int16_t pin;
+    uint8_t* pixels;
+};
+
+#endif // HOST_ADAFRUIT_NEOPIXEL_H
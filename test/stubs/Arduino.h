@@ -0,0 +1,46 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Minimal Arduino API for host tests (PlatformIO env:native). Time only
+// moves when a test sets hostMillis().
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(x, low, high) ((x) < (low) ? (low) : ((x) > (high) ? (high) : (x)))
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define MSBFIRST 1
+
+inline uint32_t& hostMillis() {
+    static uint32_t now = 0;
+    return now;
+}
+
+inline uint32_t millis() { return hostMillis(); }
+inline uint32_t micros() { return hostMillis() * 1000; }
+inline void delay(unsigned long) {}
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline long random(long limit) { return limit > 0 ? rand() % limit : 0; }
+inline long random(long low, long high) { return low + random(high - low); }
+inline void randomSeed(unsigned long seed) { srand(seed); }
+
+struct HostSerial {
+    void begin(long) {}
+    template<typename T> void print(T) {}
+    template<typename T> void print(T, int) {}
+    template<typename T> void println(T) {}
+    template<typename T> void println(T, int) {}
+    void println() {}
+};
+static HostSerial Serial __attribute__((unused));
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,38 @@
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+// 1 KB like the ATmega328's; addresses wrap as they do on the chip
+
+#include <stdint.h>
+#include <string.h>
+
+struct HostEeprom {
+    uint8_t bytes[1024];
+    
+    uint16_t length() const { return sizeof(bytes); }
+    uint8_t read(int address) const { return bytes[address & (sizeof(bytes) - 1)]; }
+    void write(int address, uint8_t value) { bytes[address & (sizeof(bytes) - 1)] = value; }
+    void update(int address, uint8_t value) { write(address, value); }
+    template<typename T> T& get(int address, T& value) const {
+        uint8_t* p = (uint8_t*)&value;
+        for (unsigned i = 0; i < sizeof(T); i++) {
+            p[i] = read(address + i);
+        }
+        return value;
+    }
+    template<typename T> const T& put(int address, const T& value) {
+        const uint8_t* p = (const uint8_t*)&value;
+        for (unsigned i = 0; i < sizeof(T); i++) {
+            write(address + i, p[i]);
+        }
+        return value;
+    }
+};
+
+inline HostEeprom& hostEeprom() {
+    static HostEeprom eeprom;
+    return eeprom;
+}
+#define EEPROM hostEeprom()
+
+#endif // HOST_EEPROM_H
@@ -0,0 +1,20 @@
+#ifndef HOST_SPI_H
+#define HOST_SPI_H
+
+#include <stdint.h>
+
+#define SPI_MODE0 0
+
+struct SPISettings {
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+struct HostSpi {
+    void begin() {}
+    void beginTransaction(SPISettings) {}
+    uint8_t transfer(uint8_t) { return 0; }
+    void endTransaction() {}
+};
+static HostSpi SPI;
+
+#endif // HOST_SPI_H
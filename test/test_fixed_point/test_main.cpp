@@ -0,0 +1,156 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <unity.h>
+#include <ClockConfig.h>
+#include <ClockDisplay.h>
+#include <FastTrig.h>
+
+// Host tests for the fixed-point paths: pio test -e native
+
+static LedGeometry rotatedFace[36];
+
+void setUp() {
+    hostMillis() = 0;
+}
+
+void tearDown() {
+}
+
+static void test_fast_wave_spans_full_range() {
+    TEST_ASSERT_EQUAL_UINT8(127, fastWave8(0));
+    TEST_ASSERT_EQUAL_UINT8(255, fastWave8(16384));
+    TEST_ASSERT_EQUAL_UINT8(0, fastWave8(49152));
+}
+
+static void test_compositor_blend_weights() {
+    ClockCompositor layers(1);
+    uint32_t white = Adafruit_NeoPixel::Color(255, 255, 255);
+
+    layers.blendPixel(ClockCompositor::LAYER_BACKGROUND, 0, white, 0);
+    uint8_t r, g, b;
+    layers.composePixel(0, r, g, b);
+    TEST_ASSERT_EQUAL_UINT8(0, r);
+
+    layers.blendPixel(ClockCompositor::LAYER_BACKGROUND, 0, white, 128);
+    layers.composePixel(0, r, g, b);
+    TEST_ASSERT_EQUAL_UINT8(127, r);
+
+    layers.blendPixel(ClockCompositor::LAYER_BACKGROUND, 0, white, 256);
+    layers.composePixel(0, r, g, b);
+    TEST_ASSERT_EQUAL_UINT8(255, r);
+
+    // Adds saturate rather than wrap
+    layers.addPixel(ClockCompositor::LAYER_BACKGROUND, 0, white);
+    layers.composePixel(0, r, g, b);
+    TEST_ASSERT_EQUAL_UINT8(255, r);
+}
+
+static void test_quiet_level_edges() {
+    // 22:00 to 06:00 with a 30 minute ramp
+    TEST_ASSERT_EQUAL_UINT16(0, getQuietLevel(21, 59, 59, 22, 6, 30));
+    TEST_ASSERT_EQUAL_UINT16(0, getQuietLevel(22, 0, 0, 22, 6, 30));
+    TEST_ASSERT_EQUAL_UINT16(128, getQuietLevel(22, 15, 0, 22, 6, 30));
+    TEST_ASSERT_EQUAL_UINT16(256, getQuietLevel(22, 30, 0, 22, 6, 30));
+    TEST_ASSERT_EQUAL_UINT16(256, getQuietLevel(3, 0, 0, 22, 6, 30));
+    TEST_ASSERT_EQUAL_UINT16(256, getQuietLevel(6, 0, 0, 22, 6, 30));
+    TEST_ASSERT_EQUAL_UINT16(128, getQuietLevel(6, 15, 0, 22, 6, 30));
+    TEST_ASSERT_EQUAL_UINT16(0, getQuietLevel(6, 30, 0, 22, 6, 30));
+
+    // No ramp is the old hard switch
+    TEST_ASSERT_EQUAL_UINT16(256, getQuietLevel(22, 0, 0, 22, 6, 0));
+    TEST_ASSERT_EQUAL_UINT16(0, getQuietLevel(6, 0, 0, 22, 6, 0));
+}
+
+static void test_full_brightness_output_does_not_wrap() {
+    ClockDisplay display(6, 1, 1, 255);
+    display.begin();
+    display.getCompositor().setPixel(ClockCompositor::LAYER_BACKGROUND, 0, Adafruit_NeoPixel::Color(255, 255, 255));
+    display.setQuietLevel(256);
+    display.show();
+
+    // Red is neutral in the warm quiet balance, so it keeps full scale
+    TEST_ASSERT_EQUAL_UINT8(255, display.getOutput().getBuffer()[0]);
+}
+
+static void test_required_fps_holds_full_rate_while_dithering() {
+    ClockDisplay display(6, 24, 12, 255);
+    display.begin();
+    display.displayPattern(ClockDisplay::DEFAULT_COMPLEMENT);
+    TEST_ASSERT_EQUAL_UINT8(ClockDisplay::getPatternFps(ClockDisplay::DEFAULT_COMPLEMENT), display.getRequiredFps(60));
+
+    display.setDithering(ClockDisplay::OUTER_RING, true);
+    TEST_ASSERT_EQUAL_UINT8(60, display.getRequiredFps(60));
+}
+
+// Largest channel difference between each built-in pattern's descriptor
+// and its PatternVM program
+static int descriptorProgramDifference(const RingGeometry& geometry) {
+    ClockDisplay display(6, geometry, 255);
+    display.begin();
+    int leds = geometry.getLedCount();
+    int worst = 0;
+
+    for (uint8_t pattern = 0; pattern < ClockDisplay::PATTERN_COUNT; pattern++) {
+        // The first call catches the hue up, so both renders see the same hue
+        hostMillis() = 123456 + pattern * 777;
+        display.displayPattern((ClockDisplay::Pattern)pattern);
+
+        uint8_t expected[36 * 3];
+        display.displayPattern((ClockDisplay::Pattern)pattern);
+        for (int i = 0; i < leds; i++) {
+            display.getCompositor().composePixel(i, expected[i * 3], expected[i * 3 + 1], expected[i * 3 + 2]);
+        }
+
+        display.displayProgram((const uint8_t*)pgm_read_ptr(&PATTERN_PROGRAMS[pattern]));
+        for (int i = 0; i < leds; i++) {
+            uint8_t actual[3];
+            display.getCompositor().composePixel(i, actual[0], actual[1], actual[2]);
+            for (int c = 0; c < 3; c++) {
+                worst = max(worst, abs(actual[c] - expected[i * 3 + c]));
+            }
+        }
+    }
+    return worst;
+}
+
+static void test_descriptors_match_programs() {
+    TEST_ASSERT_LESS_OR_EQUAL_INT(1, descriptorProgramDifference(RingGeometry(24, 12)));
+
+    // The same rings starting at 6 o'clock
+    for (int i = 0; i < 24; i++) {
+        rotatedFace[i].ring = 0;
+        rotatedFace[i].angle = 32768 + i * 65536L / 24;
+    }
+    for (int i = 0; i < 12; i++) {
+        rotatedFace[24 + i].ring = 1;
+        rotatedFace[24 + i].angle = 32768 + i * 65536L / 12;
+    }
+    TEST_ASSERT_LESS_OR_EQUAL_INT(1, descriptorProgramDifference(RingGeometry(rotatedFace, 36)));
+}
+
+static void test_color_correction_stays_inside_eeprom() {
+    static const uint16_t RINGS[] = { 60, 24, 12 };
+    ClockDisplay display(6, RingGeometry(RINGS, 3), 255);
+    display.begin();
+    display.setLedCorrection(0, 200, 200, 200);
+
+    memset(EEPROM.bytes, 0xAA, sizeof(EEPROM.bytes));
+    TEST_ASSERT_EQUAL_UINT16(303, display.getColorCorrectionSize(true));
+    TEST_ASSERT_FALSE(display.saveColorCorrection(768));
+    TEST_ASSERT_EQUAL_UINT8(0xAA, EEPROM.read(0));
+
+    TEST_ASSERT_TRUE(display.saveColorCorrection(700));
+    TEST_ASSERT_TRUE(display.loadColorCorrection(700));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fast_wave_spans_full_range);
+    RUN_TEST(test_compositor_blend_weights);
+    RUN_TEST(test_quiet_level_edges);
+    RUN_TEST(test_full_brightness_output_does_not_wrap);
+    RUN_TEST(test_required_fps_holds_full_rate_while_dithering);
+    RUN_TEST(test_descriptors_match_programs);
+    RUN_TEST(test_color_correction_stays_inside_eeprom);
+    return UNITY_END();
+}